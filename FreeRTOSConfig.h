@@ -45,13 +45,41 @@
 #define configUSE_TICKLESS_IDLE         0
 #define configUSE_PREEMPTION			1
 #define configUSE_TIME_SLICING			1
-#define configUSE_IDLE_HOOK				0
+#define configUSE_IDLE_HOOK				1	/* Calls vPortHeapIdleMaintenance(), see main.c. */
 #define configUSE_TICK_HOOK				1
 #define configCPU_CLOCK_HZ				( ( unsigned long ) 25000000 )
 #define configTICK_RATE_HZ				( ( TickType_t ) 100 )
 #define configMINIMAL_STACK_SIZE		( ( unsigned short ) 80 )
-#define configHEAP_ALLOCATION_TYPE		3 
+#define configHEAP_ALLOCATION_TYPE		8	/* 8 -> first/best/worst/next fit chosen with xPortSetAllocationPolicy(). */
 #define configTOTAL_HEAP_SIZE			( ( size_t ) ( 4 * 1024 ) )
+#define configHEAP_USE_LINKER_REGION	0	/* 1 -> the heap is the RAM from _rtos_heap_bottom to __StackLimit and configTOTAL_HEAP_SIZE is ignored. */
+#define configHEAP_MAX_BLOCK_SIZE_LOG2	12	/* 2^12 > configTOTAL_HEAP_SIZE, sizes the TLSF index. */
+#define configHEAP_BOUNDARY_TAGS		0	/* 1 -> O(1) merging in vPortFree() for first/best/worst fit. */
+#define configHEAP_BEST_FIT_TREE		0	/* 1 -> best-fit searches an AVL tree of the free blocks ordered by size. */
+#define configHEAP_COMPACT_HEADERS		0	/* 1 -> 4 byte block headers, the free list link is kept in the free block itself. */
+#define configHEAP_INCREMENTAL_STATS	0	/* 1 -> vPortGetHeapStats() copies counters instead of walking the free list, sizes rounded down to a power of two. */
+#define configHEAP_USE_POOLS			0	/* 1 -> pvPortMalloc() serves fitting requests from xPortPoolCreate() pools. */
+#define configHEAP_MAX_POOLS			4
+#define configHEAP_USE_SCRATCH_ARENAS	0	/* 1 -> builds the xPortScratchCreate() mark/release arenas of heap_scratch.c. */
+#define configHEAP_USE_REGIONS			0	/* 1 -> main.c gives vPortDefineHeapRegions() a fast region and the free RAM. */
+#define configHEAP_MAX_REGIONS			4
+#define configHEAP_FAST_REGION			0	/* Region favoured by pvPortMallocWithHint( x, eHeapHintFast ). */
+#define configHEAP_ISR_BLOCK_COUNT		0	/* Blocks reserved for pvPortMallocFromISR(), taken from the top of the heap. */
+#define configHEAP_ISR_BLOCK_SIZE		64
+#define configHEAP_TASK_ACCOUNTING		0	/* 1 -> every block is charged to the task that allocated it, see uxPortGetTaskHeapStats(). */
+#define configHEAP_MAX_ACCOUNTED_TASKS	8	/* Entry 0 collects the blocks of no task and of the tasks that do not fit. */
+#define configHEAP_FAST_BIN_COUNT		0	/* > 0 -> freed blocks of the smallest sizes are cached unmerged for the next request of their size. */
+#define configHEAP_FAST_BIN_DEPTH		4	/* Blocks cached per size, merged back from the idle hook. */
+#define configHEAP_DEFERRED_COALESCING	0	/* 1 -> vPortFree() defers merging the block to the idle hook or to a failed search. */
+#define configHEAP_DEFERRED_MERGE_BATCH	8	/* Pending frees merged per call of the idle hook. */
+#define configHEAP_PREZERO_FREE_BLOCKS	0	/* 1 -> the idle hook zeroes freed blocks, so pvPortCalloc() need not. */
+#define configHEAP_PREZERO_BYTES_PER_CALL	256	/* Bytes zeroed per call of the idle hook. */
+#define configHEAP_USE_HANDLES			0	/* 1 -> xHeapHandleAlloc() blocks, which the heap may move while they are unlocked. */
+#define configHEAP_MAX_HANDLES			8
+#define configHEAP_PERF_COUNTERS		0	/* 1 -> vPortGetHeapPerfStats() reports search lengths and cycles of pvPortMalloc() and vPortFree(). */
+#define configHEAP_PERF_USE_CMSDK_TIMER	1	/* Count with CMSDK dual timer 1, QEMU does not model the DWT cycle counter. */
+#define configHEAP_USE_TRACE			0	/* 1 -> MemMang/heap_trace.c records every heap operation, see traceMALLOC() below. */
+#define configHEAP_TRACE_RECORDS		256	/* 16 bytes each, the oldest are overwritten. */
 #define configMAX_TASK_NAME_LEN			( 12 )
 #define configUSE_16_BIT_TICKS			0
 #define configIDLE_SHOULD_YIELD			0
@@ -127,6 +155,22 @@ machine on which the test is developed). */
 	#define configASSERT( x ) if( ( x ) == 0 ) vAssertCalled( __FILE__, __LINE__ );
 #endif
 
+/* Feed the heap operations to the recorder of MemMang/heap_trace.c. */
+#if ( configHEAP_USE_TRACE == 1 ) && !defined( __IASMARM__ )
+	void vPortHeapTraceMalloc( void *pvAddress, size_t xSize );
+	void vPortHeapTraceFree( void *pvAddress, size_t xSize );
+	#define traceMALLOC( pvAddress, uiSize )	vPortHeapTraceMalloc( pvAddress, uiSize )
+	#define traceFREE( pvAddress, uiSize )		vPortHeapTraceFree( pvAddress, uiSize )
+#endif
+
+/* Release the heap accounting entry of a task when it is deleted, see
+vPortReleaseTaskHeapStats(). */
+#if ( configHEAP_TASK_ACCOUNTING == 1 ) && !defined( __IASMARM__ )
+	struct tskTaskControlBlock;
+	void vPortReleaseTaskHeapStats( struct tskTaskControlBlock *xTask );
+	#define traceTASK_DELETE( pxTaskToDelete )	vPortReleaseTaskHeapStats( pxTaskToDelete )
+#endif
+
 #define intqHIGHER_PRIORITY		( configMAX_PRIORITIES - 5 )
 #define bktPRIMARY_PRIORITY		( configMAX_PRIORITIES - 3 )
 #define bktSECONDARY_PRIORITY	( configMAX_PRIORITIES - 4 )
@@ -44,6 +44,8 @@
 
 #include "FreeRTOS.h"
 #include "task.h"
+#include "heap_pool.h"
+#include "heap_4_revised.h"
 
 #undef MPU_WRAPPERS_INCLUDED_FROM_API_FILE
 
@@ -55,8 +57,128 @@
     #define configHEAP_CLEAR_MEMORY_ON_FREE    0
 #endif
 
-/* Block sizes must not get too small. */
-#define heapMINIMUM_BLOCK_SIZE    ( ( size_t ) ( xHeapStructSize << 1 ) )
+/* configHEAP_ALLOCATION_TYPE selects how a free block is chosen:
+ * 1 -> best-fit, 2 -> worst-fit, 4 -> TLSF (two-level segregated fit),
+ * 5 -> segregated fit (one free list per size class), 6 -> next-fit,
+ * 7 -> binary buddy system, 8 -> first, best, worst or next fit as selected
+ * at run time with xPortSetAllocationPolicy(), anything else -> first-fit. */
+#ifndef configHEAP_ALLOCATION_TYPE
+    #define configHEAP_ALLOCATION_TYPE    0
+#endif
+
+/* Every block handled by the segregated allocation types must be smaller than
+ * 2 ^ configHEAP_MAX_BLOCK_SIZE_LOG2 bytes.  Only used to size their indexes. */
+#ifndef configHEAP_MAX_BLOCK_SIZE_LOG2
+    #define configHEAP_MAX_BLOCK_SIZE_LOG2    16
+#endif
+
+/* Set configHEAP_BOUNDARY_TAGS to 1 to let vPortFree() merge a block with its
+ * physical neighbours in constant time with the first, best and worst fit
+ * types too.  The free list is then doubly linked and no longer kept in
+ * address order, so a freed block is simply pushed on its head. */
+#ifndef configHEAP_BOUNDARY_TAGS
+    #define configHEAP_BOUNDARY_TAGS    0
+#endif
+
+/* Set configHEAP_INCREMENTAL_STATS to 1 to keep the free block count and the
+ * size classes of the free blocks up to date on every change of the free
+ * list(s), so vPortGetHeapStats() no longer walks them.  The largest and
+ * smallest free block sizes are then reported rounded down to a power of
+ * two. */
+#ifndef configHEAP_INCREMENTAL_STATS
+    #define configHEAP_INCREMENTAL_STATS    0
+#endif
+
+/* Set configHEAP_BEST_FIT_TREE to 1 to let best-fit (configHEAP_ALLOCATION_TYPE
+ * 1) find its block in a balanced tree of the free blocks ordered by size,
+ * in O(log n) instead of walking the whole free list. */
+#ifndef configHEAP_BEST_FIT_TREE
+    #define configHEAP_BEST_FIT_TREE    0
+#endif
+
+/* Set configHEAP_USE_LINKER_REGION to 1 to use all the RAM between the
+ * _rtos_heap_bottom and __StackLimit symbols of the linker script as the heap,
+ * instead of a ucHeap array of configTOTAL_HEAP_SIZE bytes. */
+#ifndef configHEAP_USE_LINKER_REGION
+    #define configHEAP_USE_LINKER_REGION    0
+#endif
+
+/* Set configHEAP_COMPACT_HEADERS to 1 to keep only the size of an allocated
+ * block in front of it, 4 bytes instead of 8 on a 32 bit target.  The link to
+ * the next free block is then stored in the payload of a free block. */
+#ifndef configHEAP_COMPACT_HEADERS
+    #define configHEAP_COMPACT_HEADERS    0
+#endif
+
+/* Next-fit remembers where its last search finished, also when it is one of the
+ * policies configHEAP_ALLOCATION_TYPE 8 chooses from at run time. */
+#if ( configHEAP_ALLOCATION_TYPE == 6 ) || ( configHEAP_ALLOCATION_TYPE == 8 )
+    #define heapUSE_NEXT_FIT_ROVER    1
+#else
+    #define heapUSE_NEXT_FIT_ROVER    0
+#endif
+
+#if ( configHEAP_ALLOCATION_TYPE == 1 ) && ( configHEAP_BEST_FIT_TREE == 1 )
+    #define heapUSE_BEST_FIT_TREE    1
+#else
+    #define heapUSE_BEST_FIT_TREE    0
+#endif
+
+/* TLSF, segregated fit and the buddy system keep the free blocks in several
+ * lists, selected by the size of the block, instead of in the single xStart
+ * list. */
+#if ( configHEAP_ALLOCATION_TYPE == 4 ) || ( configHEAP_ALLOCATION_TYPE == 5 ) || ( configHEAP_ALLOCATION_TYPE == 7 )
+    #define heapUSE_SEGREGATED_LISTS    1
+#else
+    #define heapUSE_SEGREGATED_LISTS    0
+#endif
+
+/* The segregated lists and the best-fit tree are indexes that give a suitable
+ * free block straight away, instead of a walk of the xStart list. */
+#if ( heapUSE_SEGREGATED_LISTS == 1 ) || ( heapUSE_BEST_FIT_TREE == 1 )
+    #define heapUSE_INDEXED_FREE_BLOCKS    1
+#else
+    #define heapUSE_INDEXED_FREE_BLOCKS    0
+#endif
+
+/* Boundary tags are a copy of the xBlockSize member (allocation bit included)
+ * kept in the last size_t of every block, so the physical neighbours of a
+ * block can be found in constant time.  TLSF and segregated fit always use
+ * them, and so does the best-fit tree, which has no address ordered list to
+ * merge blocks with.  The buddy system finds the only neighbour it can merge
+ * with from the address of the block, so it never needs them. */
+#if ( configHEAP_ALLOCATION_TYPE == 4 ) || ( configHEAP_ALLOCATION_TYPE == 5 ) || ( heapUSE_BEST_FIT_TREE == 1 )
+    #define heapUSE_BOUNDARY_TAGS    1
+#elif ( configHEAP_BOUNDARY_TAGS == 1 ) && ( configHEAP_ALLOCATION_TYPE != 7 )
+    #define heapUSE_BOUNDARY_TAGS    1
+#else
+    #define heapUSE_BOUNDARY_TAGS    0
+#endif
+
+/* Block sizes must not get too small.  A free block in the best-fit tree holds
+ * two child pointers and its height after the header, and its footer. */
+#if ( heapUSE_BEST_FIT_TREE == 1 )
+    #define heapMINIMUM_BLOCK_SIZE    ( ( size_t ) ( ( xHeapStructSize + ( 2U * sizeof( BlockLink_t * ) ) + sizeof( size_t ) + heapFOOTER_SIZE + portBYTE_ALIGNMENT_MASK ) & ~( ( size_t ) portBYTE_ALIGNMENT_MASK ) ) )
+#elif ( configHEAP_COMPACT_HEADERS == 1 )
+    #define heapMINIMUM_BLOCK_SIZE    ( ( size_t ) ( ( sizeof( BlockLink_t ) + portBYTE_ALIGNMENT_MASK ) & ~( ( size_t ) portBYTE_ALIGNMENT_MASK ) ) )
+#else
+    #define heapMINIMUM_BLOCK_SIZE    ( ( size_t ) ( xHeapStructSize << 1 ) )
+#endif
+
+/* With compact headers a block starts heapBLOCK_START_OFFSET bytes after an
+ * aligned address, so the memory after its xBlockSize member is aligned, and
+ * the end marker needs room for both members. */
+#if ( configHEAP_COMPACT_HEADERS == 1 )
+    #define heapBLOCK_START_OFFSET    ( ( size_t ) ( ( portBYTE_ALIGNMENT - ( sizeof( size_t ) & portBYTE_ALIGNMENT_MASK ) ) & portBYTE_ALIGNMENT_MASK ) )
+    #define heapEND_MARKER_SIZE       ( sizeof( BlockLink_t ) )
+#else
+    #define heapBLOCK_START_OFFSET    ( ( size_t ) 0 )
+    #define heapEND_MARKER_SIZE       ( xHeapStructSize )
+#endif
+
+/* Address of the end marker of a heap, or heap region, of xSize bytes whose
+ * first block is at uxStart. */
+#define heapEND_MARKER_ADDRESS( uxStart, xSize )    ( ( uxStart ) + ( ( portPOINTER_SIZE_TYPE ) ( ( xSize ) - heapEND_MARKER_SIZE ) & ~( ( portPOINTER_SIZE_TYPE ) portBYTE_ALIGNMENT_MASK ) ) )
 
 /* Assumes 8bit bytes! */
 #define heapBITS_PER_BYTE         ( ( size_t ) 8 )
@@ -83,25 +205,395 @@
 #define heapALLOCATE_BLOCK( pxBlock )            ( ( pxBlock->xBlockSize ) |= heapBLOCK_ALLOCATED_BITMASK )
 #define heapFREE_BLOCK( pxBlock )                ( ( pxBlock->xBlockSize ) &= ~heapBLOCK_ALLOCATED_BITMASK )
 
+#if ( heapUSE_BOUNDARY_TAGS == 1 ) || ( heapUSE_SEGREGATED_LISTS == 1 )
+
+/* Doubly linked free lists store a pointer to the previous block in the list
+ * straight after the BlockLink_t header of a free block. */
+    #define heapPREV_FREE_BLOCK( pxBlock )      ( *( ( BlockLink_t ** ) ( void * ) ( ( ( uint8_t * ) ( pxBlock ) ) + xHeapStructSize ) ) )
+#endif
+
+#if ( heapUSE_BOUNDARY_TAGS == 1 )
+
+/* The footer of a block is the last size_t of the block.  heapMINIMUM_BLOCK_SIZE
+ * is always large enough to hold the header, the back link and the footer. */
+    #define heapBLOCK_FOOTER( pxBlock )         ( *( ( size_t * ) ( void * ) ( ( ( uint8_t * ) ( pxBlock ) ) + ( ( pxBlock )->xBlockSize & ~heapBLOCK_ALLOCATED_BITMASK ) - sizeof( size_t ) ) ) )
+    #define heapPREVIOUS_FOOTER( pxBlock )      ( *( ( ( size_t * ) ( void * ) ( pxBlock ) ) - 1 ) )
+    #define heapWRITE_FOOTER( pxBlock )         ( heapBLOCK_FOOTER( pxBlock ) = ( pxBlock )->xBlockSize )
+    #define heapFOOTER_SIZE                     ( sizeof( size_t ) )
+#else
+    #define heapWRITE_FOOTER( pxBlock )
+    #define heapFOOTER_SIZE                     ( ( size_t ) 0 )
+#endif /* heapUSE_BOUNDARY_TAGS */
+
+#if ( heapUSE_BEST_FIT_TREE == 1 )
+
+/* A free block in the best-fit tree uses its pxNextFreeBlock member and the
+ * back link slot as left and right child pointers, followed by the height of
+ * the subtree it is the root of.  The tree is ordered by block size, then by
+ * address.  An AVL tree of n nodes is less than 1.45 * log2( n + 2 ) high,
+ * which bounds the paths kept while linking and unlinking blocks. */
+    #define heapTREE_LEFT_SLOT( pxNode )             ( &( ( pxNode )->pxNextFreeBlock ) )
+    #define heapTREE_RIGHT_SLOT( pxNode )            ( &heapPREV_FREE_BLOCK( pxNode ) )
+    #define heapTREE_HEIGHT( pxNode )                ( *( ( size_t * ) ( void * ) ( ( ( uint8_t * ) ( pxNode ) ) + xHeapStructSize + sizeof( BlockLink_t * ) ) ) )
+    #define heapTREE_LOAD( ppxSlot )                 heapPROTECT_BLOCK_POINTER( *( ppxSlot ) )
+    #define heapTREE_STORE( ppxSlot, pxNode )        ( *( ppxSlot ) = heapPROTECT_BLOCK_POINTER( pxNode ) )
+    #define heapTREE_LEFT( pxNode )                  heapTREE_LOAD( heapTREE_LEFT_SLOT( pxNode ) )
+    #define heapTREE_RIGHT( pxNode )                 heapTREE_LOAD( heapTREE_RIGHT_SLOT( pxNode ) )
+    #define heapTREE_SET_LEFT( pxNode, pxChild )     heapTREE_STORE( heapTREE_LEFT_SLOT( pxNode ), pxChild )
+    #define heapTREE_SET_RIGHT( pxNode, pxChild )    heapTREE_STORE( heapTREE_RIGHT_SLOT( pxNode ), pxChild )
+    #define heapTREE_MAX_HEIGHT                      ( ( ( configHEAP_MAX_BLOCK_SIZE_LOG2 * 3U ) / 2U ) + 2U )
+#endif /* heapUSE_BEST_FIT_TREE */
+
+#if ( configHEAP_ALLOCATION_TYPE == 4 ) || ( configHEAP_ALLOCATION_TYPE == 7 ) || ( configHEAP_INCREMENTAL_STATS == 1 ) || ( configHEAP_ISR_BLOCK_COUNT > 0 )
+    #include "cmsis_compiler.h"
+#endif
+
+#if ( configHEAP_ALLOCATION_TYPE == 4 ) || ( configHEAP_ALLOCATION_TYPE == 7 ) || ( configHEAP_INCREMENTAL_STATS == 1 )
+
+/* Index of the most and the least significant bit set in a non zero value. */
+    #define heapFLS( x )                        ( 31U - ( uint32_t ) __CLZ( ( uint32_t ) ( x ) ) )
+    #define heapFFS( x )                        heapFLS( ( x ) & ( ~( x ) + 1U ) )
+#endif
+
+#if ( configHEAP_ISR_BLOCK_COUNT > 0 )
+
+/* The blocks reserved for interrupts are rounded up so the next one stays
+ * aligned.  The first word of a free block points to the next free block. */
+    #if ( configHEAP_ISR_BLOCK_SIZE < 4 )
+        #error configHEAP_ISR_BLOCK_SIZE must be large enough to hold a pointer
+    #endif
+    #define heapISR_BLOCK_SIZE                  ( ( ( size_t ) configHEAP_ISR_BLOCK_SIZE + portBYTE_ALIGNMENT_MASK ) & ~( ( size_t ) portBYTE_ALIGNMENT_MASK ) )
+    #define heapISR_RESERVED_SIZE               ( heapISR_BLOCK_SIZE * ( size_t ) configHEAP_ISR_BLOCK_COUNT )
+    #define heapISR_NEXT_FREE_BLOCK( pvBlock )  ( *( ( void ** ) ( pvBlock ) ) )
+
+/* Exclusive access to the head of the stack of free reserved blocks. */
+    #define heapISR_LOAD_EXCLUSIVE( pulHead )              ( ( void * ) __LDREXW( pulHead ) )
+    #define heapISR_STORE_EXCLUSIVE( pvBlock, pulHead )    __STREXW( ( uint32_t ) ( pvBlock ), pulHead )
+    #define heapISR_CLEAR_EXCLUSIVE()                      __CLREX()
+#endif /* configHEAP_ISR_BLOCK_COUNT */
+
+#if ( configHEAP_INCREMENTAL_STATS == 1 )
+
+/* Free blocks are counted per power of two size class, class n holding the
+ * blocks of 2^n to 2^(n+1)-1 bytes. */
+    #define heapSTATS_CLASS_COUNT               ( 32U )
+    #define heapSTATS_ADD_FREE_BLOCK( xSize )       prvStatsAddFreeBlock( xSize )
+    #define heapSTATS_REMOVE_FREE_BLOCK( xSize )    prvStatsRemoveFreeBlock( xSize )
+#else
+    #define heapSTATS_ADD_FREE_BLOCK( xSize )
+    #define heapSTATS_REMOVE_FREE_BLOCK( xSize )
+#endif /* configHEAP_INCREMENTAL_STATS */
+
+#if ( configHEAP_ALLOCATION_TYPE == 4 )
+
+/* Each first level (power of two) size class is split into
+ * heapTLSF_SL_INDEX_COUNT linear second level classes.  Blocks smaller than
+ * heapTLSF_SMALL_BLOCK_SIZE all live in first level 0, which is split in
+ * portBYTE_ALIGNMENT steps. */
+    #define heapTLSF_SL_INDEX_COUNT_LOG2        ( 3U )
+    #define heapTLSF_SL_INDEX_COUNT             ( 1U << heapTLSF_SL_INDEX_COUNT_LOG2 )
+    #define heapTLSF_SMALL_BLOCK_SIZE           ( ( size_t ) ( heapTLSF_SL_INDEX_COUNT * portBYTE_ALIGNMENT ) )
+    #define heapTLSF_FL_INDEX_SHIFT             ( heapFLS( heapTLSF_SMALL_BLOCK_SIZE ) )
+    #define heapTLSF_FL_INDEX_COUNT             ( configHEAP_MAX_BLOCK_SIZE_LOG2 - heapTLSF_SL_INDEX_COUNT_LOG2 )
+    #define heapFREE_LIST_COUNT                 ( heapTLSF_FL_INDEX_COUNT * heapTLSF_SL_INDEX_COUNT )
+#endif /* configHEAP_ALLOCATION_TYPE == 4 */
+
+#if ( configHEAP_ALLOCATION_TYPE == 5 )
+
+/* Segregated fit: free blocks of 16-31, 32-63, 64-127, 128-255 and 256-511
+ * bytes each have their own list, larger free blocks share the last one. */
+    #define heapSEGREGATED_SMALLEST_CLASS_SIZE    ( ( size_t ) 16 )
+    #define heapSEGREGATED_SMALL_CLASS_COUNT      ( 5U )
+    #define heapSEGREGATED_LARGE_LIST             ( heapSEGREGATED_SMALL_CLASS_COUNT )
+    #define heapFREE_LIST_COUNT                   ( heapSEGREGATED_SMALL_CLASS_COUNT + 1U )
+#endif /* configHEAP_ALLOCATION_TYPE == 5 */
+
+#if ( configHEAP_ALLOCATION_TYPE == 7 )
+
+/* Buddy system: every block is 2^n bytes, header included, and starts at an
+ * offset from the start of the heap that is a multiple of its size.  Free
+ * blocks of 2^n bytes are kept in pxFreeLists[ n ]. */
+    #define heapFREE_LIST_COUNT                 ( ( UBaseType_t ) configHEAP_MAX_BLOCK_SIZE_LOG2 )
+    #define heapBUDDY_MAX_BLOCK_SIZE            ( ( ( size_t ) 1 ) << ( configHEAP_MAX_BLOCK_SIZE_LOG2 - 1 ) )
+    #define heapBUDDY_BLOCK_AT( xOffset )       ( ( BlockLink_t * ) ( void * ) ( pucBuddyHeapStart + ( xOffset ) ) )
+#endif /* configHEAP_ALLOCATION_TYPE == 7 */
+
 /*-----------------------------------------------------------*/
 
 /* Allocate the memory for the heap. */
-#if ( configAPPLICATION_ALLOCATED_HEAP == 1 )
+#if ( configHEAP_USE_REGIONS == 1 )
+
+/* The heap is made of the regions passed to vPortDefineHeapRegions(), which
+ * all lie between pucHeapLowAddress and pucHeapHighAddress. */
+    #define heapSTART_ADDRESS    ( pucHeapLowAddress )
+    #define heapTOTAL_SIZE       ( ( size_t ) ( pucHeapHighAddress - pucHeapLowAddress ) )
+#elif ( configHEAP_USE_LINKER_REGION == 1 )
+
+/* The heap is the free RAM left by the linker between the newlib heap, which
+ * follows .bss, and the bottom of the main stack, so it grows and shrinks with
+ * the image. */
+    extern uint8_t _rtos_heap_bottom[];
+    extern uint8_t __StackLimit[];
+    #define heapSTART_ADDRESS    ( &( _rtos_heap_bottom[ 0 ] ) )
+    #define heapTOTAL_SIZE       ( ( size_t ) ( __StackLimit - _rtos_heap_bottom ) )
+#elif ( configAPPLICATION_ALLOCATED_HEAP == 1 )
 
 /* The application writer has already defined the array used for the RTOS
 * heap - probably so it can be placed in a special segment or address. */
     extern uint8_t ucHeap[ configTOTAL_HEAP_SIZE ];
+    #define heapSTART_ADDRESS    ( &( ucHeap[ 0 ] ) )
+    #define heapTOTAL_SIZE       ( ( size_t ) configTOTAL_HEAP_SIZE )
 #else
     PRIVILEGED_DATA static uint8_t ucHeap[ configTOTAL_HEAP_SIZE ];
-#endif /* configAPPLICATION_ALLOCATED_HEAP */
+    #define heapSTART_ADDRESS    ( &( ucHeap[ 0 ] ) )
+    #define heapTOTAL_SIZE       ( ( size_t ) configTOTAL_HEAP_SIZE )
+#endif /* configHEAP_USE_REGIONS */
+
+#if ( configHEAP_COMPACT_HEADERS == 1 ) && ( ( heapUSE_BOUNDARY_TAGS == 1 ) || ( configHEAP_ALLOCATION_TYPE == 7 ) )
+    #error configHEAP_COMPACT_HEADERS only supports the first, best, worst and next fit types without boundary tags
+#endif
+
+#if ( configHEAP_USE_REGIONS == 1 )
+
+/* The regions are chained through their end markers, which only the
+ * address-ordered free list of heap_4.c can step over. */
+    #if ( heapUSE_INDEXED_FREE_BLOCKS == 1 ) || ( heapUSE_BOUNDARY_TAGS == 1 ) || ( configHEAP_ALLOCATION_TYPE == 7 )
+        #error configHEAP_USE_REGIONS only supports the first, best, worst and next fit types without boundary tags
+    #endif
+
+    #if ( configHEAP_USE_LINKER_REGION == 1 ) || ( configHEAP_ISR_BLOCK_COUNT > 0 )
+        #error configHEAP_USE_REGIONS cannot be combined with configHEAP_USE_LINKER_REGION or configHEAP_ISR_BLOCK_COUNT
+    #endif
+
+/* A search of pvPortMallocWithHint() only takes blocks that lie inside the
+ * placement range, or outside it if xPlacementInside is pdFALSE.  The empty
+ * range outside of which every block lies is the default. */
+    #define heapBLOCK_IN_PLACEMENT( pxBlock )                                                                            \
+    ( ( ( ( uint8_t * ) ( pxBlock ) >= pucPlacementStart ) && ( ( uint8_t * ) ( pxBlock ) < pucPlacementEnd ) ) == \
+      ( xPlacementInside != pdFALSE ) )
+    #define heapWIDEN_PLACEMENT()                   prvWidenPlacement()
+    #define heapREGION_ALLOCATED( pxBlock )         prvUpdateRegionStats( ( pxBlock ), pdTRUE )
+    #define heapREGION_FREED( pxBlock )             prvUpdateRegionStats( ( pxBlock ), pdFALSE )
+#else
+    #define heapBLOCK_IN_PLACEMENT( pxBlock )       ( pdTRUE )
+    #define heapWIDEN_PLACEMENT()                   ( pdFALSE )
+    #define heapREGION_ALLOCATED( pxBlock )
+    #define heapREGION_FREED( pxBlock )
+#endif /* configHEAP_USE_REGIONS */
+
+#if ( configHEAP_TASK_ACCOUNTING == 1 )
+
+/* The owner of an allocated block is kept in its pxNextFreeBlock member, see
+ * heapBLOCK_OWNER, and xTaskHeapStats[ 0 ] collects whatever no other entry
+ * can take. */
+    #if ( configHEAP_COMPACT_HEADERS == 1 )
+        #error configHEAP_TASK_ACCOUNTING needs the pxNextFreeBlock member that configHEAP_COMPACT_HEADERS removes from allocated blocks
+    #endif
+
+    #if ( configHEAP_MAX_ACCOUNTED_TASKS < 2 )
+        #error configHEAP_MAX_ACCOUNTED_TASKS must be at least 2
+    #endif
+
+    #define heapTASK_ALLOCATED( pxBlock, pxOwner )    prvUpdateTaskStats( ( pxBlock ), ( pxOwner ), pdTRUE )
+    #define heapTASK_FREED( pxBlock )                 prvUpdateTaskStats( ( pxBlock ), heapBLOCK_OWNER( pxBlock ), pdFALSE )
+    #define heapTASK_QUOTA_ALLOWS( pxOwner, xSize )   prvTaskQuotaAllows( ( pxOwner ), ( xSize ) )
+#else
+    #define heapTASK_ALLOCATED( pxBlock, pxOwner )
+    #define heapTASK_FREED( pxBlock )
+    #define heapTASK_QUOTA_ALLOWS( pxOwner, xSize )   ( pdTRUE )
+#endif /* configHEAP_TASK_ACCOUNTING */
+
+/* With task accounting a pool object is charged to the task that takes it,
+ * like a block, and is only taken within the quota of the task. */
+#if ( configHEAP_USE_POOLS == 1 ) && ( configHEAP_TASK_ACCOUNTING == 1 )
+    #define heapPOOL_MALLOC( xWantedSize )    prvPoolMalloc( xWantedSize )
+    #define heapPOOL_FREE( pv )               prvPoolFree( pv )
+#else
+    #define heapPOOL_MALLOC( xWantedSize )    pvPortPoolMalloc( ( xWantedSize ), heapSIZE_MAX )
+    #define heapPOOL_FREE( pv )               xPortPoolFree( pv )
+#endif
+
+/* Keeping the free memory zeroed relies on the list of pending frees of
+ * deferred coalescing. */
+#if ( configHEAP_DEFERRED_COALESCING == 1 ) || ( configHEAP_PREZERO_FREE_BLOCKS == 1 )
+    #define heapUSE_PENDING_FREES    1
+#else
+    #define heapUSE_PENDING_FREES    0
+#endif
+
+#if ( configHEAP_FAST_BIN_COUNT > 0 ) || ( heapUSE_PENDING_FREES == 1 )
+
+/* The fast bins and the list of pending frees end with heapCACHE_END rather
+ * than NULL, see heapNEXT_FREE_BLOCK_IS_CLEAR. */
+    #define heapCACHE_END    ( &xStart )
+#endif
+
+#if ( configHEAP_FAST_BIN_COUNT > 0 )
+
+/* Fast bin n caches up to configHEAP_FAST_BIN_DEPTH freed blocks of exactly
+ * heapMINIMUM_BLOCK_SIZE + ( n * portBYTE_ALIGNMENT ) bytes.  A cached block
+ * keeps its allocated bit, so it is neither merged with its neighbours nor
+ * seen by the searches, and its pxNextFreeBlock links it into the bin.  The
+ * last block of a bin links to heapCACHE_END rather than NULL, so giving it to
+ * vPortFree() again is caught as other double frees are. */
+    #define heapFAST_BIN_PUSH( pxBlock )    prvPushFastBin( pxBlock )
+    #define heapFAST_BIN_POP( xBlockSize )  prvPopFastBin( xBlockSize )
+    #define heapFLUSH_FAST_BINS()           prvFlushFastBins()
+#else
+    #define heapFAST_BIN_PUSH( pxBlock )    ( pdFALSE )
+    #define heapFAST_BIN_POP( xBlockSize )  ( NULL )
+    #define heapFLUSH_FAST_BINS()           ( pdFALSE )
+#endif /* configHEAP_FAST_BIN_COUNT */
+
+#if ( configHEAP_PREZERO_FREE_BLOCKS == 1 )
+
+/* Every block in the free list(s) is zero from heapMINIMUM_BLOCK_SIZE bytes
+ * after its start up to its footer, if any.  Only the bytes in front, its
+ * link area, need clearing when the block is handed out.  A block that held
+ * data goes on the list of pending frees, where it keeps its allocated bit
+ * until it has been zeroed, and when two free blocks are merged the footer of
+ * the lower one and the link area of the upper one are zeroed as they end up
+ * inside the merged block. */
+    #define heapINSERT_FREED_BLOCK( pxBlock )       prvDeferFree( pxBlock )
+    #define heapINSERT_DIRTY_BLOCK( pxBlock )       prvDeferFree( pxBlock )
+    #define heapMERGE_PENDING_FREES()               prvScrubPendingFrees( heapSIZE_MAX )
+    #define heapLINK_AREA_SIZE( pxBlock )           ( ( ( pxBlock )->xBlockSize < heapMINIMUM_BLOCK_SIZE ) ? ( pxBlock )->xBlockSize : heapMINIMUM_BLOCK_SIZE )
+    #define heapWANTS_ZEROED_BLOCK( uxFlags )       ( ( ( uxFlags ) & heapREQUEST_ZEROED ) != 0U )
+    #define heapZERO_JOINED_HEADER( pxUpperBlock )  ( void ) memset( ( ( uint8_t * ) ( pxUpperBlock ) ) - heapFOOTER_SIZE, 0, heapFOOTER_SIZE + heapLINK_AREA_SIZE( pxUpperBlock ) )
+#elif ( configHEAP_DEFERRED_COALESCING == 1 )
+
+/* vPortFree() pushes the blocks on a list of pending frees, kept like a fast
+ * bin, and they are merged into the free list(s) later, a few at a time by
+ * vPortHeapIdleMaintenance() or all at once when a search fails. */
+    #define heapINSERT_FREED_BLOCK( pxBlock )       prvDeferFree( pxBlock )
+    #define heapINSERT_DIRTY_BLOCK( pxBlock )       prvInsertBlockIntoFreeList( pxBlock )
+    #define heapMERGE_PENDING_FREES()               prvMergePendingFrees( uxPendingFrees )
+    #define heapZERO_JOINED_HEADER( pxUpperBlock )
+    #define heapWANTS_ZEROED_BLOCK( uxFlags )       ( pdFALSE )
+#else
+    #define heapINSERT_FREED_BLOCK( pxBlock )       prvInsertBlockIntoFreeList( pxBlock )
+    #define heapINSERT_DIRTY_BLOCK( pxBlock )       prvInsertBlockIntoFreeList( pxBlock )
+    #define heapMERGE_PENDING_FREES()               ( pdFALSE )
+    #define heapZERO_JOINED_HEADER( pxUpperBlock )
+    #define heapWANTS_ZEROED_BLOCK( uxFlags )       ( pdFALSE )
+#endif /* configHEAP_PREZERO_FREE_BLOCKS */
+
+/* The kind of request the variants of pvPortMalloc() pass to prvMalloc(),
+ * besides its alignment. */
+#define heapREQUEST_LONG_LIVED      ( ( UBaseType_t ) 0x01U ) /* From the high end of the heap, see pvPortMallocWithLifetime(). */
+#define heapREQUEST_ZEROED          ( ( UBaseType_t ) 0x02U ) /* Returned all zero, see pvPortCalloc(). */
+#define heapREQUEST_RELOCATABLE     ( ( UBaseType_t ) 0x04U ) /* A heap block the compaction may move, never a pool object. */
+#define heapREQUEST_FAST            ( ( UBaseType_t ) 0x08U ) /* Inside the fast region first, see pvPortMallocWithHint(). */
+#define heapREQUEST_BULK            ( ( UBaseType_t ) 0x10U ) /* Outside of the fast region first. */
+
+#if ( configHEAP_USE_HANDLES == 1 ) && ( configHEAP_ALLOCATION_TYPE != 7 )
+
+/* A search that fails slides the unlocked blocks of xHeapHandleAlloc() down
+ * into the free space below them before it gives up.  Buddy blocks cannot
+ * move to an arbitrary address, so they never do. */
+    #define heapCOMPACT_HEAP()    prvCompactHeap( ~( ( UBaseType_t ) 0U ) )
+#else
+    #define heapCOMPACT_HEAP()    ( pdFALSE )
+#endif
+
+#if ( configHEAP_USE_HANDLES == 1 )
+
+/* An entry of the table behind HeapHandle_t, free while pvBlock is NULL. */
+    typedef struct xHeapHandle
+    {
+        void * pvBlock;          /**< The memory of the block, as returned by pvPortMalloc(). */
+        UBaseType_t uxLockCount; /**< The block may only move while this is 0. */
+    } HeapHandleEntry_t;
+
+    #define heapVALIDATE_HANDLE( xHandle )                 \
+    configASSERT( ( ( xHandle ) >= &( xHeapHandles[ 0 ] ) ) && \
+                  ( ( xHandle ) < &( xHeapHandles[ configHEAP_MAX_HANDLES ] ) ) )
+#endif
+
+#if ( configHEAP_PERF_COUNTERS == 1 )
+
+/* The cycle counter defaults to the DWT cycle counter of the core, or to dual
+ * timer 1 of the CMSDK, which is started free running in 32-bit mode and
+ * counts down from 0xFFFFFFFF, so its inverted value counts up.  Starting
+ * either twice is harmless. */
+    #ifndef configHEAP_PERF_GET_CYCLE_COUNT
+        #include "CMSDK_CM3.h"
+
+        #if ( configHEAP_PERF_USE_CMSDK_TIMER == 1 )
+            #define configHEAP_PERF_START_CYCLE_COUNTER()                                 \
+    ( CMSDK_DUALTIMER1->TimerControl = CMSDK_DUALTIMER1_CTRL_EN_Msk | CMSDK_DUALTIMER1_CTRL_SIZE_Msk )
+            #define configHEAP_PERF_GET_CYCLE_COUNT()    ( ~( ( uint32_t ) CMSDK_DUALTIMER1->TimerValue ) )
+        #else
+            #define configHEAP_PERF_START_CYCLE_COUNTER()                      \
+    ( CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk, DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk )
+            #define configHEAP_PERF_GET_CYCLE_COUNT()    ( ( uint32_t ) DWT->CYCCNT )
+        #endif
+    #endif /* configHEAP_PERF_GET_CYCLE_COUNT */
+
+    #ifndef configHEAP_PERF_START_CYCLE_COUNTER
+        #define configHEAP_PERF_START_CYCLE_COUNTER()
+    #endif
+
+/* Each free block, free list head or tree node a search of pvPortMalloc()
+ * looks at, the end marker included, is counted in xBlocksVisited, and the
+ * total of the call, retries included, goes to the histogram once the search
+ * succeeded or gave up. */
+    #define heapPERF_TIMESTAMP( ulCycles )                                   ( ( ulCycles ) = prvPerfGetCycles() )
+    #define heapPERF_SEARCH_START()                                          ( xBlocksVisited = 0U )
+    #define heapPERF_VISIT()                                                 ( xBlocksVisited++ )
+    #define heapPERF_SEARCH_DONE()                                           prvPerfRecordSearch()
+    #define heapPERF_CALL_DONE( xCallStats, ulCallStart, ulSuspendStart )    prvPerfRecordCall( &( xPerfStats.xCallStats ), ( ulCallStart ), ( ulSuspendStart ) )
+    #define heapPERF_SUSPENDED_DONE( ulSuspendStart )                        prvPerfRecordSuspended( ulSuspendStart )
+#else
+    #define heapPERF_TIMESTAMP( ulCycles )
+    #define heapPERF_SEARCH_START()
+    #define heapPERF_VISIT()
+    #define heapPERF_SEARCH_DONE()
+    #define heapPERF_CALL_DONE( xCallStats, ulCallStart, ulSuspendStart )
+    #define heapPERF_SUSPENDED_DONE( ulSuspendStart )
+#endif /* configHEAP_PERF_COUNTERS */
 
 /* Define the linked list structure.  This is used to link free blocks in order
  * of their memory address. */
-typedef struct A_BLOCK_LINK
-{
-    struct A_BLOCK_LINK * pxNextFreeBlock; /**< The next free block in the list. */
-    size_t xBlockSize;                     /**< The size of the free block. */
-} BlockLink_t;
+#if ( configHEAP_COMPACT_HEADERS == 1 )
+
+/* Only xBlockSize is kept while the block is allocated, pxNextFreeBlock is the
+ * first word of the memory handed out. */
+    typedef struct A_BLOCK_LINK
+    {
+        size_t xBlockSize;                     /**< The size of the free block. */
+        struct A_BLOCK_LINK * pxNextFreeBlock; /**< The next free block in the list. */
+    } BlockLink_t;
+
+/* pxNextFreeBlock belongs to the application while the block is allocated, so
+ * it cannot be used to check a block given to vPortFree(). */
+    #define heapCLEAR_NEXT_FREE_BLOCK( pxBlock )
+    #define heapNEXT_FREE_BLOCK_IS_CLEAR( pxBlock )    ( pdTRUE )
+
+#else /* configHEAP_COMPACT_HEADERS */
+
+    typedef struct A_BLOCK_LINK
+    {
+        struct A_BLOCK_LINK * pxNextFreeBlock; /**< The next free block in the list. */
+        size_t xBlockSize;                     /**< The size of the free block. */
+    } BlockLink_t;
+
+/* An allocated block has no "next" block. */
+    #define heapCLEAR_NEXT_FREE_BLOCK( pxBlock )       ( ( pxBlock )->pxNextFreeBlock = NULL )
+
+    #if ( configHEAP_TASK_ACCOUNTING == 1 )
+
+/* With task accounting heapTASK_ALLOCATED() then stores the entry of
+ * xTaskHeapStats[] that the block is charged to in pxNextFreeBlock. */
+        #define heapBLOCK_OWNER( pxBlock )                 ( ( TaskHeapStats_t * ) ( void * ) ( pxBlock )->pxNextFreeBlock )
+        #define heapNEXT_FREE_BLOCK_IS_CLEAR( pxBlock )                                  \
+    ( ( heapBLOCK_OWNER( pxBlock ) >= &( xTaskHeapStats[ 0 ] ) ) &&                      \
+      ( heapBLOCK_OWNER( pxBlock ) < &( xTaskHeapStats[ configHEAP_MAX_ACCOUNTED_TASKS ] ) ) )
+    #else
+        #define heapNEXT_FREE_BLOCK_IS_CLEAR( pxBlock )    ( ( pxBlock )->pxNextFreeBlock == NULL )
+    #endif
+
+#endif /* configHEAP_COMPACT_HEADERS */
 
 /* Setting configENABLE_HEAP_PROTECTOR to 1 enables heap block pointers
  * protection using an application supplied canary value to catch heap
@@ -131,9 +623,9 @@ typedef struct A_BLOCK_LINK
 #endif /* configENABLE_HEAP_PROTECTOR */
 
 /* Assert that a heap block pointer is within the heap bounds. */
-#define heapVALIDATE_BLOCK_POINTER( pxBlock )                          \
-    configASSERT( ( ( uint8_t * ) ( pxBlock ) >= &( ucHeap[ 0 ] ) ) && \
-                  ( ( uint8_t * ) ( pxBlock ) <= &( ucHeap[ configTOTAL_HEAP_SIZE - 1 ] ) ) )
+#define heapVALIDATE_BLOCK_POINTER( pxBlock )                       \
+    configASSERT( ( ( uint8_t * ) ( pxBlock ) >= heapSTART_ADDRESS ) && \
+                  ( ( uint8_t * ) ( pxBlock ) < ( heapSTART_ADDRESS + heapTOTAL_SIZE ) ) )
 
 /*-----------------------------------------------------------*/
 
@@ -145,237 +637,3696 @@ typedef struct A_BLOCK_LINK
  */
 static void prvInsertBlockIntoFreeList( BlockLink_t * pxBlockToInsert ) PRIVILEGED_FUNCTION;
 
+/*
+ * Return the size of the block, header included, that holds xWantedSize bytes,
+ * or 0 if xWantedSize is 0 or too large.
+ */
+static size_t prvGetBlockSize( size_t xWantedSize ) PRIVILEGED_FUNCTION;
+
+/*
+ * Allocate xWantedSize bytes for pvPortMalloc() and its variants, with the
+ * payload aligned on xAlignment bytes, or on portBYTE_ALIGNMENT if it is 0,
+ * for a request of the kind given by the heapREQUEST_ flags in uxFlags.
+ */
+static void * prvMalloc( size_t xWantedSize,
+                         size_t xAlignment,
+                         UBaseType_t uxFlags ) PRIVILEGED_FUNCTION;
+
+/*
+ * Resize the allocated block pxBlock to xWantedSize bytes, a size returned by
+ * prvGetBlockSize(), without moving it.  A block shrinks by giving its tail
+ * back to the heap and grows by taking in the free block that follows it.
+ * Returns pdFALSE, and leaves the block as it is, if it cannot grow in place.
+ */
+static BaseType_t prvResizeBlock( BlockLink_t * pxBlock,
+                                  size_t xWantedSize ) PRIVILEGED_FUNCTION;
+
+#if ( configHEAP_ALLOCATION_TYPE != 7 )
+
+/*
+ * Give the head of the free block pxBlock, taken out of the free list(s) for
+ * a request of xWantedSize bytes, back to the heap as a free block of its own.
+ * The head is the gap in front of the first payload aligned on xAlignment
+ * bytes for a pvPortMallocAligned() request, and, when xAlignment is 0, all
+ * but the top xWantedSize bytes for a long-lived request of
+ * pvPortMallocWithLifetime().  Returns the block that remains.
+ * ppxPreviousBlock is the list predecessor of pxBlock when the free blocks
+ * are kept in an address ordered list, and is moved onto the head.
+ */
+    static BlockLink_t * prvSplitBlockHead( BlockLink_t * pxBlock,
+                                            size_t xWantedSize,
+                                            size_t xAlignment,
+                                            BlockLink_t ** ppxPreviousBlock ) PRIVILEGED_FUNCTION;
+
+#endif /* configHEAP_ALLOCATION_TYPE != 7 */
+
+#if ( configHEAP_USE_REGIONS == 0 )
+
 /*
  * Called automatically to setup the required heap structures the first time
  * pvPortMalloc() is called.
  */
-static void prvHeapInit( void ) PRIVILEGED_FUNCTION;
+    static void prvHeapInit( void ) PRIVILEGED_FUNCTION;
 
-/*-----------------------------------------------------------*/
+#else /* configHEAP_USE_REGIONS */
 
-/* The size of the structure placed at the beginning of each allocated memory
- * block must by correctly byte aligned. */
-static const size_t xHeapStructSize = ( sizeof( BlockLink_t ) + ( ( size_t ) ( portBYTE_ALIGNMENT - 1 ) ) ) & ~( ( size_t ) portBYTE_ALIGNMENT_MASK );
+/*
+ * Drop the placement of a pvPortMallocWithHint() search, so it is done again
+ * over the whole heap.  Returns pdFALSE if the search was not restricted.
+ */
+    static BaseType_t prvWidenPlacement( void ) PRIVILEGED_FUNCTION;
 
-/* Create a couple of list links to mark the start and end of the list. */
-PRIVILEGED_DATA static BlockLink_t xStart;
-PRIVILEGED_DATA static BlockLink_t * pxEnd = NULL;
+/*
+ * Account pxBlock, which is being allocated or freed, to its region.
+ */
+    static void prvUpdateRegionStats( const BlockLink_t * pxBlock,
+                                      BaseType_t xAllocated ) PRIVILEGED_FUNCTION;
 
-/* Keeps track of the number of calls to allocate and free memory as well as the
- * number of free bytes remaining, but says nothing about fragmentation. */
-PRIVILEGED_DATA static size_t xFreeBytesRemaining = 0U;
-PRIVILEGED_DATA static size_t xMinimumEverFreeBytesRemaining = 0U;
-PRIVILEGED_DATA static size_t xNumberOfSuccessfulAllocations = 0;
-PRIVILEGED_DATA static size_t xNumberOfSuccessfulFrees = 0;
+#endif /* configHEAP_USE_REGIONS */
 
-/*-----------------------------------------------------------*/
+#if ( configHEAP_TASK_ACCOUNTING == 1 )
 
- 
-void * pvPortMalloc( size_t xWantedSize )
-{
-    BlockLink_t * pxBlock;
+/*
+ * Return the entry of xTaskHeapStats[] of xTask, taking a new one if xTask has
+ * none yet, or xTaskHeapStats[ 0 ] if xTask is NULL or the table is full.
+ */
+    static TaskHeapStats_t * prvGetTaskEntry( TaskHandle_t xTask ) PRIVILEGED_FUNCTION;
 
-    // Ensure that configHEAP_ALLOCATION_TYPE is defined
-    #if (configHEAP_ALLOCATION_TYPE)
-        BlockLink_t * pxBlockTmp = NULL;
-        BlockLink_t * pxPreviousBlockTmp = NULL;
-    #endif
+/*
+ * Return the entry the calling task is charged to, xTaskHeapStats[ 0 ] before
+ * the scheduler starts.
+ */
+    static TaskHeapStats_t * prvGetCallerEntry( void ) PRIVILEGED_FUNCTION;
 
-    BlockLink_t * pxPreviousBlock;
-    BlockLink_t * pxNewBlockLink;
-    void * pvReturn = NULL;
-    size_t xAdditionalRequiredSize;
+/*
+ * Return the number of bytes pxEntry may still take within its quota.
+ */
+    static size_t prvTaskQuotaLeft( const TaskHeapStats_t * pxEntry ) PRIVILEGED_FUNCTION;
 
-    if( xWantedSize > 0 )
-    {
-        /* The wanted size must be increased so it can contain a BlockLink_t
-         * structure in addition to the requested amount of bytes. */
-        if( heapADD_WILL_OVERFLOW( xWantedSize, xHeapStructSize ) == 0 )
-        {
-            xWantedSize += xHeapStructSize;
+/*
+ * Return pdFALSE if pxEntry cannot hold xSize more bytes within its quota.
+ */
+    static BaseType_t prvTaskQuotaAllows( const TaskHeapStats_t * pxEntry,
+                                          size_t xSize ) PRIVILEGED_FUNCTION;
 
-            /* Ensure that blocks are always aligned to the required number
-             * of bytes. */
-            if( ( xWantedSize & portBYTE_ALIGNMENT_MASK ) != 0x00 )
-            {
-                /* Byte alignment required. */
-                xAdditionalRequiredSize = portBYTE_ALIGNMENT - ( xWantedSize & portBYTE_ALIGNMENT_MASK );
+/*
+ * Charge pxBlock, which is being allocated, to pxOwner, or credit pxOwner with
+ * pxBlock, which is being freed.
+ */
+    static void prvUpdateTaskStats( BlockLink_t * pxBlock,
+                                    TaskHeapStats_t * pxOwner,
+                                    BaseType_t xAllocated ) PRIVILEGED_FUNCTION;
 
-                if( heapADD_WILL_OVERFLOW( xWantedSize, xAdditionalRequiredSize ) == 0 )
-                {
-                    xWantedSize += xAdditionalRequiredSize;
-                }
-                else
-                {
-                    xWantedSize = 0;
-                }
-            }
-            else
-            {
-                mtCOVERAGE_TEST_MARKER();
-            }
-        }
-        else
-        {
-            xWantedSize = 0;
-        }
-    }
-    else
-    {
-        mtCOVERAGE_TEST_MARKER();
-    }
+/*
+ * Charge xSize bytes, which are being allocated, to pxOwner, or credit pxOwner
+ * with xSize bytes, which are being freed.
+ */
+    static void prvUpdateTaskBytes( TaskHeapStats_t * pxOwner,
+                                    size_t xSize,
+                                    BaseType_t xAllocated ) PRIVILEGED_FUNCTION;
 
-    vTaskSuspendAll();
-    {
-        /* If this is the first call to malloc then the heap will require
-         * initialisation to setup the list of free blocks. */
-        if( pxEnd == NULL )
-        {
-            prvHeapInit();
-        }
-        else
-        {
-            mtCOVERAGE_TEST_MARKER();
-        }
+    #if ( configHEAP_USE_POOLS == 1 )
 
-        /* Check the block size we are trying to allocate is not so large that the
-         * top bit is set.  The top bit of the block size member of the BlockLink_t
-         * structure is used to determine who owns the block - the application or
-         * the kernel, so it must be free. */
-        if( heapBLOCK_SIZE_IS_VALID( xWantedSize ) != 0 )
-        {
-            if( ( xWantedSize > 0 ) && ( xWantedSize <= xFreeBytesRemaining ) )
-            {
-                /* Traverse the list from the start (lowest address) block until
-                 * one of adequate size is found. */
-                pxPreviousBlock = &xStart;
-                pxBlock = heapPROTECT_BLOCK_POINTER( xStart.pxNextFreeBlock );
-                heapVALIDATE_BLOCK_POINTER( pxBlock );
-                
-
-                /** CUSTOM HEAP ALLOCATION TYPE */
-                /** best-fit */
-                 #if (configHEAP_ALLOCATION_TYPE == 1)
-                    configASSERT( heapSUBTRACT_WILL_UNDERFLOW( pxBlock->xBlockSize, xWantedSize ) == 0 );
-                    /* traverse the whole free block list */
-                    while( pxBlock->pxNextFreeBlock != heapPROTECT_BLOCK_POINTER( NULL ) )
-                    {
-                        /* Check if the current block is a valid option and if another valid block
-                           was found before and check wheter is a best fit */
-                        if  (   ( pxBlock->xBlockSize >= xWantedSize )
-                                &&
-                                (   pxBlockTmp == NULL
-                                    ||
-                                    ( ( pxBlock->xBlockSize - xWantedSize ) < ( pxBlockTmp->xBlockSize - xWantedSize ) )
-                                )
-                            )
-                        {
-                            pxPreviousBlockTmp = pxPreviousBlock;
-                            pxBlockTmp = pxBlock;
-                        }
-                        pxPreviousBlock = pxBlock;
-                        pxBlock = heapPROTECT_BLOCK_POINTER( pxBlock->pxNextFreeBlock );
-                        heapVALIDATE_BLOCK_POINTER( pxBlock );
-                    }
-                    pxPreviousBlock = pxPreviousBlockTmp;
-                    pxBlock = pxBlockTmp;
-                /** worst-fit */
-                #elif (configHEAP_ALLOCATION_TYPE == 2)
-                    configASSERT( heapSUBTRACT_WILL_UNDERFLOW( pxBlock->xBlockSize, xWantedSize ) == 0 );
-                    /* traverse the whole free block list */
-                    while( pxBlock->pxNextFreeBlock != heapPROTECT_BLOCK_POINTER( NULL ) )
-                    {
-                        /* Check if the current block is a valid option and if another valid block
-                           was found before and check wheter is a worst fit */
-                        if  (   ( pxBlock->xBlockSize >= xWantedSize )
-                                &&
-                                (   pxBlockTmp == NULL
-                                    ||
-                                    ( ( pxBlock->xBlockSize - xWantedSize ) > ( pxBlockTmp->xBlockSize - xWantedSize ) )
-                                )
-                            )
-                        {
-                            pxPreviousBlockTmp = pxPreviousBlock;
-                            pxBlockTmp = pxBlock;
-                        }
-                        pxPreviousBlock = pxBlock;
-                        pxBlock = heapPROTECT_BLOCK_POINTER( pxBlock->pxNextFreeBlock );
-                        heapVALIDATE_BLOCK_POINTER( pxBlock );
-                    }
-                    pxPreviousBlock = pxPreviousBlockTmp;
-                    pxBlock = pxBlockTmp;
-                /** first-fit */
-                #else
-                    while( ( pxBlock->xBlockSize < xWantedSize ) && ( pxBlock->pxNextFreeBlock != heapPROTECT_BLOCK_POINTER( NULL ) ) )
-                    {
-                        pxPreviousBlock = pxBlock;
-                        pxBlock = heapPROTECT_BLOCK_POINTER( pxBlock->pxNextFreeBlock );
-                        heapVALIDATE_BLOCK_POINTER( pxBlock );
-                    }
-                #endif
+/*
+ * pvPortPoolMalloc() and xPortPoolFree(), charging the object to the calling
+ * task and crediting it back to its owner.
+ */
+        static void * prvPoolMalloc( size_t xWantedSize ) PRIVILEGED_FUNCTION;
+        static BaseType_t prvPoolFree( void * pv ) PRIVILEGED_FUNCTION;
 
+    #endif /* configHEAP_USE_POOLS */
 
-                /* If the end marker was reached then a block of adequate size
-                 * was not found. */
-                if( pxBlock != pxEnd )
-                {
-                    /* Return the memory space pointed to - jumping over the
-                     * BlockLink_t structure at its start. */
-                    pvReturn = ( void * ) ( ( ( uint8_t * ) heapPROTECT_BLOCK_POINTER( pxPreviousBlock->pxNextFreeBlock ) ) + xHeapStructSize );
-                    heapVALIDATE_BLOCK_POINTER( pvReturn );
+#endif /* configHEAP_TASK_ACCOUNTING */
 
-                    /* This block is being returned for use so must be taken out
-                     * of the list of free blocks. */
-                    pxPreviousBlock->pxNextFreeBlock = pxBlock->pxNextFreeBlock;
+#if ( configHEAP_FAST_BIN_COUNT > 0 )
 
-                    /* If the block is larger than required it can be split into
-                     * two. */
-                    configASSERT( heapSUBTRACT_WILL_UNDERFLOW( pxBlock->xBlockSize, xWantedSize ) == 0 );
+/*
+ * Cache pxBlock, which is being freed, in the fast bin of its size.  Returns
+ * pdFALSE if it has no bin or the bin is full, the block must then go to the
+ * free list(s).
+ */
+    static BaseType_t prvPushFastBin( BlockLink_t * pxBlock ) PRIVILEGED_FUNCTION;
 
-                    if( ( pxBlock->xBlockSize - xWantedSize ) > heapMINIMUM_BLOCK_SIZE )
-                    {
-                        /* This block is to be split into two.  Create a new
-                         * block following the number of bytes requested. The void
-                         * cast is used to prevent byte alignment warnings from the
-                         * compiler. */
-                        pxNewBlockLink = ( void * ) ( ( ( uint8_t * ) pxBlock ) + xWantedSize );
-                        configASSERT( ( ( ( size_t ) pxNewBlockLink ) & portBYTE_ALIGNMENT_MASK ) == 0 );
-
-                        /* Calculate the sizes of two blocks split from the
-                         * single block. */
-                        pxNewBlockLink->xBlockSize = pxBlock->xBlockSize - xWantedSize;
-                        pxBlock->xBlockSize = xWantedSize;
-
-                        /* Insert the new block into the list of free blocks. */
-                        pxNewBlockLink->pxNextFreeBlock = pxPreviousBlock->pxNextFreeBlock;
-                        pxPreviousBlock->pxNextFreeBlock = heapPROTECT_BLOCK_POINTER( pxNewBlockLink );
-                    }
-                    else
-                    {
-                        mtCOVERAGE_TEST_MARKER();
-                    }
+/*
+ * Take the most recently cached block of xBlockSize bytes out of its fast
+ * bin.  Returns NULL if there is none the current request may use.
+ */
+    static BlockLink_t * prvPopFastBin( size_t xBlockSize ) PRIVILEGED_FUNCTION;
 
-                    xFreeBytesRemaining -= pxBlock->xBlockSize;
+/*
+ * Give every cached block to prvInsertBlockIntoFreeList(), so it merges with
+ * its free neighbours, or to the pending frees if it must be zeroed first.
+ * Returns pdFALSE if the bins were empty.
+ */
+    static BaseType_t prvFlushFastBins( void ) PRIVILEGED_FUNCTION;
 
-                    if( xFreeBytesRemaining < xMinimumEverFreeBytesRemaining )
-                    {
-                        xMinimumEverFreeBytesRemaining = xFreeBytesRemaining;
-                    }
-                    else
+#endif /* configHEAP_FAST_BIN_COUNT */
+
+#if ( heapUSE_PENDING_FREES == 1 )
+
+/*
+ * Push pxBlock, which is being freed, on the list of pending frees.
+ */
+    static void prvDeferFree( BlockLink_t * pxBlock ) PRIVILEGED_FUNCTION;
+
+#endif /* heapUSE_PENDING_FREES */
+
+#if ( configHEAP_PREZERO_FREE_BLOCKS == 1 )
+
+/*
+ * Zero up to xMaxBytes bytes of the pending frees, and give each one that is
+ * then done to prvInsertBlockIntoFreeList().  The block being zeroed is taken
+ * off the list and carried over to the next call.  Returns pdFALSE if no block
+ * was merged.
+ */
+    static BaseType_t prvScrubPendingFrees( size_t xMaxBytes ) PRIVILEGED_FUNCTION;
+
+#elif ( configHEAP_DEFERRED_COALESCING == 1 )
+
+/*
+ * Give up to uxMaxBlocks pending frees to prvInsertBlockIntoFreeList().
+ * Returns pdFALSE if there were none.
+ */
+    static BaseType_t prvMergePendingFrees( UBaseType_t uxMaxBlocks ) PRIVILEGED_FUNCTION;
+
+#endif /* configHEAP_PREZERO_FREE_BLOCKS */
+
+#if ( configHEAP_USE_HANDLES == 1 ) && ( configHEAP_ALLOCATION_TYPE != 7 )
+
+/*
+ * Move the block of pxHandle down into the free block physically in front of
+ * it, if there is one, and give the bytes it leaves at its top back to the
+ * heap, where they merge with the free block above, if any.  Returns pdFALSE
+ * if the block did not move.
+ */
+    static BaseType_t prvMoveBlockDown( HeapHandleEntry_t * pxHandle ) PRIVILEGED_FUNCTION;
+
+/*
+ * Move the blocks of the unlocked handles down, at most uxMaxMoves times,
+ * until none of them has a free block in front of it.  Returns pdFALSE if no
+ * block moved.
+ */
+    static BaseType_t prvCompactHeap( UBaseType_t uxMaxMoves ) PRIVILEGED_FUNCTION;
+
+#endif /* ( configHEAP_USE_HANDLES == 1 ) && ( configHEAP_ALLOCATION_TYPE != 7 ) */
+
+#if ( configHEAP_PERF_COUNTERS == 1 )
+
+/*
+ * Return the cycle counter, starting it on the first call.
+ */
+    static uint32_t prvPerfGetCycles( void ) PRIVILEGED_FUNCTION;
+
+/*
+ * Add xBlocksVisited to the search histogram.
+ */
+    static void prvPerfRecordSearch( void ) PRIVILEGED_FUNCTION;
+
+/*
+ * Account for a call that started at ulCallStart and suspended the scheduler
+ * at ulSuspendStart.  Called with the scheduler still suspended.
+ */
+    static void prvPerfRecordCall( HeapPerfCallStats_t * pxCallStats,
+                                   uint32_t ulCallStart,
+                                   uint32_t ulSuspendStart ) PRIVILEGED_FUNCTION;
+
+/*
+ * Account for a section that suspended the scheduler at ulSuspendStart in the
+ * longest time the scheduler was kept suspended.  Called with the scheduler
+ * still suspended.
+ */
+    static void prvPerfRecordSuspended( uint32_t ulSuspendStart ) PRIVILEGED_FUNCTION;
+
+#endif /* configHEAP_PERF_COUNTERS */
+
+#if ( heapUSE_BOUNDARY_TAGS == 1 ) || ( heapUSE_SEGREGATED_LISTS == 1 )
+
+/*
+ * Add a free block to, or remove a free block from, the free list(s) without
+ * merging it with its neighbours.  Both run in constant time.
+ */
+    static void prvLinkFreeBlock( BlockLink_t * pxBlock ) PRIVILEGED_FUNCTION;
+    static void prvUnlinkFreeBlock( BlockLink_t * pxBlock ) PRIVILEGED_FUNCTION;
+
+#endif /* ( heapUSE_BOUNDARY_TAGS == 1 ) || ( heapUSE_SEGREGATED_LISTS == 1 ) */
+
+#if ( heapUSE_SEGREGATED_LISTS == 1 )
+
+/*
+ * Return the index, in pxFreeLists[], of the list that holds free blocks of
+ * xSize bytes.
+ */
+    static UBaseType_t prvFreeListIndex( size_t xSize ) PRIVILEGED_FUNCTION;
+
+#endif /* heapUSE_SEGREGATED_LISTS */
+
+#if ( heapUSE_INDEXED_FREE_BLOCKS == 0 )
+
+/*
+ * Walk the xStart list for a free block of at least xWantedSize bytes with the
+ * allocation policy, or with prvHighestFit() when uxFlags holds
+ * heapREQUEST_LONG_LIVED.  Return the block, or pxEnd if there is none, and
+ * the entry in front of it in *ppxPreviousBlock.  The block is left in the
+ * list.
+ */
+    static BlockLink_t * prvSearchFreeList( size_t xWantedSize,
+                                            UBaseType_t uxFlags,
+                                            BlockLink_t ** ppxPreviousBlock ) PRIVILEGED_FUNCTION;
+
+    static BlockLink_t * prvHighestFit( size_t xWantedSize,
+                                        BlockLink_t ** ppxPreviousBlock ) PRIVILEGED_FUNCTION;
+
+    #if ( configHEAP_ALLOCATION_TYPE != 1 ) && ( configHEAP_ALLOCATION_TYPE != 2 ) && ( configHEAP_ALLOCATION_TYPE != 6 )
+        static BlockLink_t * prvFirstFit( size_t xWantedSize,
+                                          BlockLink_t ** ppxPreviousBlock ) PRIVILEGED_FUNCTION;
+    #endif
+
+    #if ( configHEAP_ALLOCATION_TYPE == 1 ) || ( configHEAP_ALLOCATION_TYPE == 8 )
+        static BlockLink_t * prvBestFit( size_t xWantedSize,
+                                         BlockLink_t ** ppxPreviousBlock ) PRIVILEGED_FUNCTION;
+    #endif
+
+    #if ( configHEAP_ALLOCATION_TYPE == 2 ) || ( configHEAP_ALLOCATION_TYPE == 8 )
+        static BlockLink_t * prvWorstFit( size_t xWantedSize,
+                                          BlockLink_t ** ppxPreviousBlock ) PRIVILEGED_FUNCTION;
+    #endif
+
+    #if ( heapUSE_NEXT_FIT_ROVER == 1 )
+        static BlockLink_t * prvNextFit( size_t xWantedSize,
+                                         BlockLink_t ** ppxPreviousBlock ) PRIVILEGED_FUNCTION;
+    #endif
+
+#endif /* heapUSE_INDEXED_FREE_BLOCKS */
+
+#if ( heapUSE_INDEXED_FREE_BLOCKS == 1 )
+
+/*
+ * Return a free block of at least xWantedSize bytes, or NULL if there is none.
+ * The block is left in its free list.
+ */
+    static BlockLink_t * prvFindFreeBlock( size_t xWantedSize ) PRIVILEGED_FUNCTION;
+
+#endif /* heapUSE_INDEXED_FREE_BLOCKS */
+
+#if ( heapUSE_BEST_FIT_TREE == 1 )
+
+/*
+ * Restore the AVL balance of the subtree rooted at pxNode, whose own subtrees
+ * are balanced, and return its new root.
+ */
+    static BlockLink_t * prvTreeBalance( BlockLink_t * pxNode ) PRIVILEGED_FUNCTION;
+
+#endif /* heapUSE_BEST_FIT_TREE */
+
+#if ( configHEAP_INCREMENTAL_STATS == 1 )
+
+/*
+ * Account for a block of xSize bytes entering or leaving the free list(s).
+ * Must be called with the block's size as it is while in the list.
+ */
+    static void prvStatsAddFreeBlock( size_t xSize ) PRIVILEGED_FUNCTION;
+    static void prvStatsRemoveFreeBlock( size_t xSize ) PRIVILEGED_FUNCTION;
+
+#endif /* configHEAP_INCREMENTAL_STATS */
+
+#if ( configHEAP_ALLOCATION_TYPE == 4 )
+
+/*
+ * Calculate the first and second level indexes of the TLSF list that holds
+ * free blocks of xSize bytes.
+ */
+    static void prvTLSFMapping( size_t xSize,
+                                UBaseType_t * puxFirstLevel,
+                                UBaseType_t * puxSecondLevel ) PRIVILEGED_FUNCTION;
+
+#endif /* configHEAP_ALLOCATION_TYPE == 4 */
+
+/*-----------------------------------------------------------*/
+
+/* The size of the structure placed at the beginning of each allocated memory
+ * block must by correctly byte aligned.  With compact headers it is only the
+ * xBlockSize member, and the block itself is offset instead. */
+#if ( configHEAP_COMPACT_HEADERS == 1 )
+    static const size_t xHeapStructSize = sizeof( size_t );
+#else
+    static const size_t xHeapStructSize = ( sizeof( BlockLink_t ) + ( ( size_t ) ( portBYTE_ALIGNMENT - 1 ) ) ) & ~( ( size_t ) portBYTE_ALIGNMENT_MASK );
+#endif
+
+/* Create a couple of list links to mark the start and end of the list. */
+PRIVILEGED_DATA static BlockLink_t xStart;
+PRIVILEGED_DATA static BlockLink_t * pxEnd = NULL;
+
+/* Keeps track of the number of calls to allocate and free memory as well as the
+ * number of free bytes remaining, but says nothing about fragmentation. */
+PRIVILEGED_DATA static size_t xFreeBytesRemaining = 0U;
+PRIVILEGED_DATA static size_t xMinimumEverFreeBytesRemaining = 0U;
+PRIVILEGED_DATA static size_t xNumberOfSuccessfulAllocations = 0;
+PRIVILEGED_DATA static size_t xNumberOfSuccessfulFrees = 0;
+
+#if ( configHEAP_USE_HANDLES == 1 )
+
+/* The handles of xHeapHandleAlloc(). */
+    PRIVILEGED_DATA static HeapHandleEntry_t xHeapHandles[ configHEAP_MAX_HANDLES ];
+
+#endif /* configHEAP_USE_HANDLES */
+
+#if ( configHEAP_PERF_COUNTERS == 1 )
+
+/* The counters of vPortGetHeapPerfStats(), and the number of free blocks the
+ * current search looked at so far. */
+    PRIVILEGED_DATA static HeapPerfStats_t xPerfStats;
+    PRIVILEGED_DATA static size_t xBlocksVisited = 0U;
+    PRIVILEGED_DATA static BaseType_t xCycleCounterStarted = pdFALSE;
+
+#endif /* configHEAP_PERF_COUNTERS */
+
+#if ( configHEAP_INCREMENTAL_STATS == 1 )
+
+/* Number of free blocks, in total and per size class.  Bit n of
+ * ulFreeBlockClassBitmap is set when class n holds at least one block. */
+    PRIVILEGED_DATA static size_t xNumberOfFreeBlocks = 0U;
+    PRIVILEGED_DATA static size_t xFreeBlocksPerClass[ heapSTATS_CLASS_COUNT ];
+    PRIVILEGED_DATA static uint32_t ulFreeBlockClassBitmap = 0U;
+
+#endif /* configHEAP_INCREMENTAL_STATS */
+
+#if ( heapUSE_BEST_FIT_TREE == 1 )
+
+/* Root of the best-fit tree, stored like the child pointers. */
+    PRIVILEGED_DATA static BlockLink_t * pxTreeRoot = NULL;
+
+#endif /* heapUSE_BEST_FIT_TREE */
+
+#if ( heapUSE_NEXT_FIT_ROVER == 1 )
+
+/* Next-fit resumes the search after this free list entry, which is the one in
+ * front of the block the last allocation came from.  It is either &xStart or a
+ * block that is in the free list. */
+    PRIVILEGED_DATA static BlockLink_t * pxNextFitRover = NULL;
+
+#endif /* heapUSE_NEXT_FIT_ROVER */
+
+#if ( configHEAP_ALLOCATION_TYPE == 8 )
+
+/* The policy set with xPortSetAllocationPolicy(). */
+    PRIVILEGED_DATA static eHeapAllocationPolicy eAllocationPolicy = eHeapPolicyFirstFit;
+
+#endif /* configHEAP_ALLOCATION_TYPE == 8 */
+
+#if ( configHEAP_USE_REGIONS == 1 )
+
+/* Lowest and highest addresses of the regions, the usage of each region in the
+ * order of the array passed to vPortDefineHeapRegions(), and the placement of
+ * the current search (see heapBLOCK_IN_PLACEMENT). */
+    PRIVILEGED_DATA static uint8_t * pucHeapLowAddress = NULL;
+    PRIVILEGED_DATA static uint8_t * pucHeapHighAddress = NULL;
+    PRIVILEGED_DATA static HeapRegionStats_t xRegionStats[ configHEAP_MAX_REGIONS ];
+    PRIVILEGED_DATA static UBaseType_t uxNumberOfRegions = 0U;
+    PRIVILEGED_DATA static uint8_t * pucPlacementStart = NULL;
+    PRIVILEGED_DATA static uint8_t * pucPlacementEnd = NULL;
+    PRIVILEGED_DATA static BaseType_t xPlacementInside = pdFALSE;
+
+#endif /* configHEAP_USE_REGIONS */
+
+#if ( configHEAP_TASK_ACCOUNTING == 1 )
+
+/* Heap usage of the accounted tasks.  An entry whose xHandle is NULL is free,
+ * except xTaskHeapStats[ 0 ], which is never given to a task. */
+    PRIVILEGED_DATA static TaskHeapStats_t xTaskHeapStats[ configHEAP_MAX_ACCOUNTED_TASKS ];
+
+#endif /* configHEAP_TASK_ACCOUNTING */
+
+#if ( configHEAP_ISR_BLOCK_COUNT > 0 )
+
+/* The blocks reserved for interrupts lie between pucISRBlocks and
+ * pucISRBlocksEnd.  ulISRFreeBlocks holds the address of the first free one,
+ * or 0 when none is free. */
+    PRIVILEGED_DATA static uint8_t * pucISRBlocks = NULL;
+    PRIVILEGED_DATA static uint8_t * pucISRBlocksEnd = NULL;
+    PRIVILEGED_DATA static volatile uint32_t ulISRFreeBlocks = 0U;
+
+#endif /* configHEAP_ISR_BLOCK_COUNT */
+
+#if ( configHEAP_FAST_BIN_COUNT > 0 )
+
+/* Heads of the fast bins, stored like pxNextFreeBlock, and the number of
+ * blocks each bin holds.  A head is only valid while its bin is not empty. */
+    PRIVILEGED_DATA static BlockLink_t * pxFastBins[ configHEAP_FAST_BIN_COUNT ];
+    PRIVILEGED_DATA static UBaseType_t uxFastBinLength[ configHEAP_FAST_BIN_COUNT ];
+
+#endif /* configHEAP_FAST_BIN_COUNT */
+
+#if ( heapUSE_PENDING_FREES == 1 )
+
+/* Head of the list of pending frees, stored like pxNextFreeBlock, and the
+ * number of blocks on it.  The head is only valid while the list is not
+ * empty. */
+    PRIVILEGED_DATA static BlockLink_t * pxPendingFrees;
+    PRIVILEGED_DATA static UBaseType_t uxPendingFrees = 0U;
+
+#endif /* heapUSE_PENDING_FREES */
+
+#if ( configHEAP_PREZERO_FREE_BLOCKS == 1 )
+
+/* The pending free that prvScrubPendingFrees() is part way through, if any,
+ * and the offset from its start up to which it has been zeroed. */
+    PRIVILEGED_DATA static BlockLink_t * pxScrubBlock = NULL;
+    PRIVILEGED_DATA static size_t xScrubOffset = 0U;
+
+#endif /* configHEAP_PREZERO_FREE_BLOCKS */
+
+#if ( configHEAP_ALLOCATION_TYPE == 7 )
+
+/* Buddies are found by XORing the offset of a block from pucBuddyHeapStart
+ * with its size.  Only the first xBuddyHeapSize bytes are split into blocks. */
+    PRIVILEGED_DATA static uint8_t * pucBuddyHeapStart = NULL;
+    PRIVILEGED_DATA static size_t xBuddyHeapSize = 0U;
+
+#endif /* configHEAP_ALLOCATION_TYPE == 7 */
+
+#if ( heapUSE_SEGREGATED_LISTS == 1 )
+
+/* Heads of the segregated free lists.  The lists are doubly linked and NULL
+ * terminated. */
+    PRIVILEGED_DATA static BlockLink_t * pxFreeLists[ heapFREE_LIST_COUNT ];
+
+#endif /* heapUSE_SEGREGATED_LISTS */
+
+#if ( configHEAP_ALLOCATION_TYPE == 4 )
+
+/* TLSF index.  The list of first level n and second level m is
+ * pxFreeLists[ ( n * heapTLSF_SL_INDEX_COUNT ) + m ].  Bit n of
+ * ulTLSFFirstLevelBitmap is set when at least one list of first level n is not
+ * empty, bit m of ulTLSFSecondLevelBitmap[ n ] is set when list m of first
+ * level n is not empty. */
+    PRIVILEGED_DATA static uint32_t ulTLSFFirstLevelBitmap = 0U;
+    PRIVILEGED_DATA static uint32_t ulTLSFSecondLevelBitmap[ heapTLSF_FL_INDEX_COUNT ];
+
+#endif /* configHEAP_ALLOCATION_TYPE == 4 */
+
+/*-----------------------------------------------------------*/
+
+void * pvPortMalloc( size_t xWantedSize )
+{
+    return prvMalloc( xWantedSize, 0U, 0U );
+}
+/*-----------------------------------------------------------*/
+
+static void * prvMalloc( size_t xWantedSize,
+                         size_t xAlignment,
+                         UBaseType_t uxFlags ) /* PRIVILEGED_FUNCTION */
+{
+    BlockLink_t * pxBlock;
+
+    #if ( heapUSE_INDEXED_FREE_BLOCKS == 0 )
+        BlockLink_t * pxPreviousBlock;
+    #endif
+
+    BlockLink_t * pxNewBlockLink;
+    void * pvReturn = NULL;
+    size_t xSearchSize;
+    size_t xRequestedSize = xWantedSize;
+    BaseType_t xCleared = pdFALSE;
+
+    #if ( configHEAP_TASK_ACCOUNTING == 1 )
+        TaskHeapStats_t * pxOwner;
+    #endif
+
+    #if ( configHEAP_PERF_COUNTERS == 1 )
+        uint32_t ulCallStart, ulSuspendStart;
+    #endif
+
+    heapPERF_TIMESTAMP( ulCallStart );
+
+    #if ( configHEAP_USE_POOLS == 1 )
+    {
+        /* A request that one of the object pools can hold is served from it.
+         * The heap is then left alone, as for a request of zero bytes.  Pool
+         * objects are only aligned on portBYTE_ALIGNMENT. */
+        if( ( xAlignment == 0U ) && ( ( uxFlags & heapREQUEST_RELOCATABLE ) == 0U ) )
+        {
+            pvReturn = heapPOOL_MALLOC( xWantedSize );
+        }
+        else
+        {
+            mtCOVERAGE_TEST_MARKER();
+        }
+
+        if( pvReturn != NULL )
+        {
+            xWantedSize = 0;
+        }
+        else
+        {
+            mtCOVERAGE_TEST_MARKER();
+        }
+    }
+    #endif /* configHEAP_USE_POOLS */
+
+    /* The wanted size must be increased so it can contain a BlockLink_t
+     * structure in addition to the requested amount of bytes. */
+    xWantedSize = prvGetBlockSize( xWantedSize );
+
+    vTaskSuspendAll();
+    {
+        heapPERF_TIMESTAMP( ulSuspendStart );
+
+        #if ( configHEAP_USE_REGIONS == 1 )
+        {
+            /* The regions must have been defined first. */
+            configASSERT( pxEnd != NULL );
+
+            /* A request of pvPortMallocWithHint() looks inside the fast
+             * region first, or outside of it, if there is one.  See
+             * heapBLOCK_IN_PLACEMENT. */
+            if( ( ( uxFlags & ( heapREQUEST_FAST | heapREQUEST_BULK ) ) != 0U ) && ( ( UBaseType_t ) configHEAP_FAST_REGION < uxNumberOfRegions ) )
+            {
+                pucPlacementStart = xRegionStats[ configHEAP_FAST_REGION ].pucStartAddress;
+                pucPlacementEnd = pucPlacementStart + xRegionStats[ configHEAP_FAST_REGION ].xSizeInBytes;
+                xPlacementInside = ( ( uxFlags & heapREQUEST_FAST ) != 0U ) ? pdTRUE : pdFALSE;
+            }
+            else
+            {
+                mtCOVERAGE_TEST_MARKER();
+            }
+        }
+        #else
+        {
+            /* If this is the first call to malloc then the heap will require
+             * initialisation to setup the list of free blocks. */
+            if( pxEnd == NULL )
+            {
+                prvHeapInit();
+            }
+            else
+            {
+                mtCOVERAGE_TEST_MARKER();
+            }
+        }
+        #endif /* configHEAP_USE_REGIONS */
+
+        /* A request of pvPortMallocAligned() needs a free block that is large
+         * enough whatever the gap in front of the first aligned address in
+         * it.  See prvSplitBlockHead(). */
+        xSearchSize = xWantedSize;
+
+        if( ( xAlignment != 0U ) && ( xWantedSize > 0 ) )
+        {
+            if( heapADD_WILL_OVERFLOW( xWantedSize, xAlignment + heapMINIMUM_BLOCK_SIZE ) == 0 )
+            {
+                xSearchSize += xAlignment + heapMINIMUM_BLOCK_SIZE;
+            }
+            else
+            {
+                xSearchSize = 0;
+            }
+        }
+        else
+        {
+            mtCOVERAGE_TEST_MARKER();
+        }
+
+        #if ( configHEAP_TASK_ACCOUNTING == 1 )
+        {
+            /* A task over its quota fails the request as if the heap were
+             * full. */
+            pxOwner = prvGetCallerEntry();
+
+            if( ( xWantedSize > 0 ) && ( prvTaskQuotaAllows( pxOwner, xWantedSize ) == pdFALSE ) )
+            {
+                pxOwner->xNumberOfQuotaFailures++;
+                xSearchSize = 0;
+            }
+            else
+            {
+                mtCOVERAGE_TEST_MARKER();
+            }
+        }
+        #endif /* configHEAP_TASK_ACCOUNTING */
+
+        /* Check the block size we are trying to allocate is not so large that the
+         * top bit is set.  The top bit of the block size member of the BlockLink_t
+         * structure is used to determine who owns the block - the application or
+         * the kernel, so it must be free. */
+        if( heapBLOCK_SIZE_IS_VALID( xSearchSize ) != 0 )
+        {
+            if( ( xSearchSize > 0 ) && ( xSearchSize <= xFreeBytesRemaining ) )
+            {
+                /* A block of exactly the wanted size cached by vPortFree()
+                 * needs neither a search nor a split.  It has not been
+                 * zeroed. */
+                pxBlock = NULL;
+
+                if( ( xAlignment == 0U ) && ( ( uxFlags & heapREQUEST_LONG_LIVED ) == 0U ) && ( heapWANTS_ZEROED_BLOCK( uxFlags ) == pdFALSE ) )
+                {
+                    pxBlock = heapFAST_BIN_POP( xWantedSize );
+                }
+                else
+                {
+                    mtCOVERAGE_TEST_MARKER();
+                }
+
+                if( pxBlock == NULL )
+                {
+                    /** TLSF, segregated fit, buddy system and best-fit tree */
+                    #if ( heapUSE_INDEXED_FREE_BLOCKS == 1 )
+                        /* The size of the request selects the list(s) to look in,
+                         * or the path down the tree, the xStart list is not
+                         * traversed.  A failed search is done again once the
+                         * fast bins have been flushed, the pending frees
+                         * merged and the heap compacted. */
+                        heapPERF_SEARCH_START();
+
+                        do
+                        {
+                            pxBlock = prvFindFreeBlock( xSearchSize );
+                        } while( ( pxBlock == NULL ) &&
+                                 ( ( heapFLUSH_FAST_BINS() != pdFALSE ) || ( heapMERGE_PENDING_FREES() != pdFALSE ) || ( heapCOMPACT_HEAP() != pdFALSE ) ) );
+
+                        heapPERF_SEARCH_DONE();
+
+                        if( pxBlock != NULL )
+                        {
+                            /* This block is being returned for use so must be taken
+                             * out of its free list. */
+                            prvUnlinkFreeBlock( pxBlock );
+
+                            #if ( configHEAP_ALLOCATION_TYPE == 7 )
+                            {
+                                /* Halve the block until it has the wanted size.  The
+                                 * upper half of each split is the buddy of the
+                                 * lower half, and the half that is not kept goes
+                                 * to the free list of its size. */
+                                while( ( pxBlock->xBlockSize >> 1 ) >= xWantedSize )
+                                {
+                                    pxBlock->xBlockSize >>= 1;
+                                    pxNewBlockLink = ( void * ) ( ( ( uint8_t * ) pxBlock ) + pxBlock->xBlockSize );
+                                    pxNewBlockLink->xBlockSize = pxBlock->xBlockSize;
+
+                                    if( ( uxFlags & heapREQUEST_LONG_LIVED ) != 0U )
+                                    {
+                                        /* Long-lived blocks keep the upper halves,
+                                         * towards the high end of the heap. */
+                                        prvLinkFreeBlock( pxBlock );
+                                        pxBlock = pxNewBlockLink;
+                                    }
+                                    else
+                                    {
+                                        prvLinkFreeBlock( pxNewBlockLink );
+                                    }
+                                }
+                            }
+                            #else /* configHEAP_ALLOCATION_TYPE == 7 */
+                            {
+                                if( ( xAlignment != 0U ) || ( ( uxFlags & heapREQUEST_LONG_LIVED ) != 0U ) )
+                                {
+                                    pxBlock = prvSplitBlockHead( pxBlock, xWantedSize, xAlignment, NULL );
+                                }
+                                else
+                                {
+                                    mtCOVERAGE_TEST_MARKER();
+                                }
+
+                                /* If the block is larger than required it can be split
+                                 * into two. */
+                                configASSERT( heapSUBTRACT_WILL_UNDERFLOW( pxBlock->xBlockSize, xWantedSize ) == 0 );
+
+                                if( ( pxBlock->xBlockSize - xWantedSize ) > heapMINIMUM_BLOCK_SIZE )
+                                {
+                                    /* The block following the remainder is never free,
+                                     * otherwise it would have been merged with pxBlock,
+                                     * so the remainder can be linked as it is. */
+                                    pxNewBlockLink = ( void * ) ( ( ( uint8_t * ) pxBlock ) + xWantedSize );
+                                    configASSERT( ( ( ( size_t ) pxNewBlockLink ) & portBYTE_ALIGNMENT_MASK ) == heapBLOCK_START_OFFSET );
+
+                                    pxNewBlockLink->xBlockSize = pxBlock->xBlockSize - xWantedSize;
+                                    pxBlock->xBlockSize = xWantedSize;
+                                    heapWRITE_FOOTER( pxNewBlockLink );
+                                    prvLinkFreeBlock( pxNewBlockLink );
+                                }
+                                else
+                                {
+                                    mtCOVERAGE_TEST_MARKER();
+                                }
+                            }
+                            #endif /* configHEAP_ALLOCATION_TYPE == 7 */
+                        }
+                        else
+                        {
+                            mtCOVERAGE_TEST_MARKER();
+                        }
+                    #else /* if ( heapUSE_INDEXED_FREE_BLOCKS == 1 ) */
+                        /* Look for a block of adequate size with the allocation
+                         * policy.  A search restricted by pvPortMallocWithHint()
+                         * that fails is done again over the whole heap, and
+                         * then again once the fast bins have been flushed,
+                         * the pending frees merged and the heap compacted. */
+                        heapPERF_SEARCH_START();
+
+                        do
+                        {
+                            pxBlock = prvSearchFreeList( xSearchSize, uxFlags, &pxPreviousBlock );
+                        } while( ( pxBlock == pxEnd ) &&
+                                 ( ( heapWIDEN_PLACEMENT() != pdFALSE ) || ( heapFLUSH_FAST_BINS() != pdFALSE ) ||
+                                   ( heapMERGE_PENDING_FREES() != pdFALSE ) || ( heapCOMPACT_HEAP() != pdFALSE ) ) );
+
+                        heapPERF_SEARCH_DONE();
+
+                        /* If the end marker was reached then a block of adequate size
+                         * was not found. */
+                        if( pxBlock != pxEnd )
+                        {
+                            /* This block is being returned for use so must be taken out
+                             * of the list of free blocks. */
+                            #if ( heapUSE_BOUNDARY_TAGS == 1 )
+                            {
+                                /* The back link replaces the list predecessor. */
+                                ( void ) pxPreviousBlock;
+                                prvUnlinkFreeBlock( pxBlock );
+                            }
+                            #else
+                            {
+                                heapSTATS_REMOVE_FREE_BLOCK( pxBlock->xBlockSize );
+                                pxPreviousBlock->pxNextFreeBlock = pxBlock->pxNextFreeBlock;
+                            }
+                            #endif
+
+                            #if ( heapUSE_NEXT_FIT_ROVER == 1 )
+                            {
+                                /* The next search starts where this one finished,
+                                 * that is on the remainder of the block, if any. */
+                                pxNextFitRover = pxPreviousBlock;
+                            }
+                            #endif
+
+                            if( ( xAlignment != 0U ) || ( ( uxFlags & heapREQUEST_LONG_LIVED ) != 0U ) )
+                            {
+                                pxBlock = prvSplitBlockHead( pxBlock, xWantedSize, xAlignment, &pxPreviousBlock );
+                            }
+                            else
+                            {
+                                mtCOVERAGE_TEST_MARKER();
+                            }
+
+                            /* If the block is larger than required it can be split into
+                             * two. */
+                            configASSERT( heapSUBTRACT_WILL_UNDERFLOW( pxBlock->xBlockSize, xWantedSize ) == 0 );
+
+                            if( ( pxBlock->xBlockSize - xWantedSize ) > heapMINIMUM_BLOCK_SIZE )
+                            {
+                                /* This block is to be split into two.  Create a new
+                                 * block following the number of bytes requested. The void
+                                 * cast is used to prevent byte alignment warnings from the
+                                 * compiler. */
+                                pxNewBlockLink = ( void * ) ( ( ( uint8_t * ) pxBlock ) + xWantedSize );
+                                configASSERT( ( ( ( size_t ) pxNewBlockLink ) & portBYTE_ALIGNMENT_MASK ) == heapBLOCK_START_OFFSET );
+
+                                /* Calculate the sizes of two blocks split from the
+                                 * single block. */
+                                pxNewBlockLink->xBlockSize = pxBlock->xBlockSize - xWantedSize;
+                                pxBlock->xBlockSize = xWantedSize;
+
+                                /* Insert the new block into the list of free blocks. */
+                                #if ( heapUSE_BOUNDARY_TAGS == 1 )
+                                {
+                                    heapWRITE_FOOTER( pxNewBlockLink );
+                                    prvLinkFreeBlock( pxNewBlockLink );
+
+                                    #if ( heapUSE_NEXT_FIT_ROVER == 1 )
+                                    {
+                                        /* The remainder was pushed on the head of
+                                         * the list. */
+                                        pxNextFitRover = &xStart;
+                                    }
+                                    #endif
+                                }
+                                #else
+                                {
+                                    heapSTATS_ADD_FREE_BLOCK( pxNewBlockLink->xBlockSize );
+                                    pxNewBlockLink->pxNextFreeBlock = pxPreviousBlock->pxNextFreeBlock;
+                                    pxPreviousBlock->pxNextFreeBlock = heapPROTECT_BLOCK_POINTER( pxNewBlockLink );
+                                }
+                                #endif
+                            }
+                            else
+                            {
+                                mtCOVERAGE_TEST_MARKER();
+                            }
+                        }
+                        else
+                        {
+                            pxBlock = NULL;
+                        }
+                    #endif /* if ( heapUSE_INDEXED_FREE_BLOCKS == 1 ) */
+                }
+                else
+                {
+                    mtCOVERAGE_TEST_MARKER();
+                }
+
+                if( pxBlock != NULL )
+                {
+                    /* Return the memory space pointed to - jumping over the
+                     * BlockLink_t structure at its start. */
+                    pvReturn = ( void * ) ( ( ( uint8_t * ) pxBlock ) + xHeapStructSize );
+                    heapVALIDATE_BLOCK_POINTER( pvReturn );
+
+                    #if ( configHEAP_PREZERO_FREE_BLOCKS == 1 )
+                    {
+                        /* The block came from the free list(s), so only its
+                         * link area is not zero yet. */
+                        if( heapWANTS_ZEROED_BLOCK( uxFlags ) != pdFALSE )
+                        {
+                            ( void ) memset( pvReturn, 0, heapLINK_AREA_SIZE( pxBlock ) - xHeapStructSize );
+                            xCleared = pdTRUE;
+                        }
+                        else
+                        {
+                            mtCOVERAGE_TEST_MARKER();
+                        }
+                    }
+                    #endif /* configHEAP_PREZERO_FREE_BLOCKS */
+
+                    xFreeBytesRemaining -= pxBlock->xBlockSize;
+                    heapREGION_ALLOCATED( pxBlock );
+
+                    if( xFreeBytesRemaining < xMinimumEverFreeBytesRemaining )
+                    {
+                        xMinimumEverFreeBytesRemaining = xFreeBytesRemaining;
+                    }
+                    else
+                    {
+                        mtCOVERAGE_TEST_MARKER();
+                    }
+
+                    /* The block is being returned - it is allocated and owned
+                     * by the application and has no "next" block. */
+                    heapALLOCATE_BLOCK( pxBlock );
+                    heapWRITE_FOOTER( pxBlock );
+                    heapCLEAR_NEXT_FREE_BLOCK( pxBlock );
+                    heapTASK_ALLOCATED( pxBlock, pxOwner );
+                    xNumberOfSuccessfulAllocations++;
+                }
+                else
+                {
+                    mtCOVERAGE_TEST_MARKER();
+                }
+            }
+            else
+            {
+                mtCOVERAGE_TEST_MARKER();
+            }
+        }
+        else
+        {
+            mtCOVERAGE_TEST_MARKER();
+        }
+
+        /* The placement of a pvPortMallocWithHint() request only holds for
+         * its own search. */
+        ( void ) heapWIDEN_PLACEMENT();
+
+        traceMALLOC( pvReturn, xWantedSize );
+
+        /* Resuming the scheduler may switch to another task, whose cycles
+         * would then be counted as well. */
+        heapPERF_CALL_DONE( xMallocCalls, ulCallStart, ulSuspendStart );
+    }
+    ( void ) xTaskResumeAll();
+
+    if( ( pvReturn != NULL ) && ( ( uxFlags & heapREQUEST_ZEROED ) != 0U ) && ( xCleared == pdFALSE ) )
+    {
+        /* A pool object, or a block of a heap that does not keep its free
+         * memory zeroed. */
+        ( void ) memset( pvReturn, 0, xRequestedSize );
+    }
+    else
+    {
+        mtCOVERAGE_TEST_MARKER();
+    }
+
+    #if ( configUSE_MALLOC_FAILED_HOOK == 1 )
+    {
+        if( pvReturn == NULL )
+        {
+            vApplicationMallocFailedHook();
+        }
+        else
+        {
+            mtCOVERAGE_TEST_MARKER();
+        }
+    }
+    #endif /* if ( configUSE_MALLOC_FAILED_HOOK == 1 ) */
+
+    configASSERT( ( ( ( size_t ) pvReturn ) & ( size_t ) portBYTE_ALIGNMENT_MASK ) == 0 );
+    return pvReturn;
+}
+
+
+/*-----------------------------------------------------------*/
+
+void vPortFree( void * pv )
+{
+    uint8_t * puc = ( uint8_t * ) pv;
+    BlockLink_t * pxLink;
+
+    #if ( configHEAP_PERF_COUNTERS == 1 )
+        uint32_t ulCallStart, ulSuspendStart;
+    #endif
+
+    heapPERF_TIMESTAMP( ulCallStart );
+
+    #if ( configHEAP_ISR_BLOCK_COUNT > 0 )
+    {
+        /* A block reserved for interrupts may be released by a task. */
+        if( ( ( uint8_t * ) pv >= pucISRBlocks ) && ( ( uint8_t * ) pv < pucISRBlocksEnd ) )
+        {
+            vPortFreeFromISR( pv );
+            pv = NULL;
+        }
+        else
+        {
+            mtCOVERAGE_TEST_MARKER();
+        }
+    }
+    #endif /* configHEAP_ISR_BLOCK_COUNT */
+
+    #if ( configHEAP_USE_POOLS == 1 )
+    {
+        /* Pool objects have no BlockLink_t header and go back to their pool. */
+        if( heapPOOL_FREE( pv ) != pdFALSE )
+        {
+            pv = NULL;
+        }
+        else
+        {
+            mtCOVERAGE_TEST_MARKER();
+        }
+    }
+    #endif /* configHEAP_USE_POOLS */
+
+    if( pv != NULL )
+    {
+        /* The memory being freed will have an BlockLink_t structure immediately
+         * before it. */
+        puc -= xHeapStructSize;
+
+        /* This casting is to keep the compiler from issuing warnings. */
+        pxLink = ( void * ) puc;
+
+        heapVALIDATE_BLOCK_POINTER( pxLink );
+        configASSERT( heapBLOCK_IS_ALLOCATED( pxLink ) != 0 );
+        configASSERT( heapNEXT_FREE_BLOCK_IS_CLEAR( pxLink ) != pdFALSE );
+
+        if( heapBLOCK_IS_ALLOCATED( pxLink ) != 0 )
+        {
+            if( heapNEXT_FREE_BLOCK_IS_CLEAR( pxLink ) != pdFALSE )
+            {
+                /* The block is being returned to the heap - it is no longer
+                 * allocated. */
+                heapFREE_BLOCK( pxLink );
+                #if ( configHEAP_CLEAR_MEMORY_ON_FREE == 1 ) && ( configHEAP_PREZERO_FREE_BLOCKS == 0 )
+                {
+                    /* Check for underflow as this can occur if xBlockSize is
+                     * overwritten in a heap block. */
+                    if( heapSUBTRACT_WILL_UNDERFLOW( pxLink->xBlockSize, xHeapStructSize ) == 0 )
+                    {
+                        ( void ) memset( puc + xHeapStructSize, 0, pxLink->xBlockSize - xHeapStructSize );
+                    }
+                }
+                #endif
+
+                vTaskSuspendAll();
+                {
+                    heapPERF_TIMESTAMP( ulSuspendStart );
+
+                    /* Add this block to the list of free blocks. */
+                    xFreeBytesRemaining += pxLink->xBlockSize;
+                    heapREGION_FREED( pxLink );
+                    heapTASK_FREED( pxLink );
+                    traceFREE( pv, pxLink->xBlockSize );
+
+                    /* Small blocks are cached unmerged for the next request
+                     * of the same size. */
+                    if( heapFAST_BIN_PUSH( pxLink ) == pdFALSE )
+                    {
+                        heapINSERT_FREED_BLOCK( ( ( BlockLink_t * ) pxLink ) );
+                    }
+                    else
+                    {
+                        mtCOVERAGE_TEST_MARKER();
+                    }
+
+                    xNumberOfSuccessfulFrees++;
+                    heapPERF_CALL_DONE( xFreeCalls, ulCallStart, ulSuspendStart );
+                }
+                ( void ) xTaskResumeAll();
+            }
+            else
+            {
+                mtCOVERAGE_TEST_MARKER();
+            }
+        }
+        else
+        {
+            mtCOVERAGE_TEST_MARKER();
+        }
+    }
+}
+/*-----------------------------------------------------------*/
+
+size_t xPortGetFreeHeapSize( void )
+{
+    return xFreeBytesRemaining;
+}
+/*-----------------------------------------------------------*/
+
+size_t xPortGetMinimumEverFreeHeapSize( void )
+{
+    return xMinimumEverFreeBytesRemaining;
+}
+/*-----------------------------------------------------------*/
+
+void xPortResetHeapMinimumEverFreeHeapSize( void )
+{
+    #if ( configHEAP_USE_REGIONS == 1 )
+        UBaseType_t uxRegion;
+    #endif
+
+    taskENTER_CRITICAL();
+    {
+        xMinimumEverFreeBytesRemaining = xFreeBytesRemaining;
+
+        #if ( configHEAP_USE_REGIONS == 1 )
+        {
+            for( uxRegion = 0U; uxRegion < uxNumberOfRegions; uxRegion++ )
+            {
+                xRegionStats[ uxRegion ].xMinimumEverFreeBytesRemaining = xRegionStats[ uxRegion ].xAvailableHeapSpaceInBytes;
+            }
+        }
+        #endif /* configHEAP_USE_REGIONS */
+    }
+    taskEXIT_CRITICAL();
+}
+/*-----------------------------------------------------------*/
+
+void vPortInitialiseBlocks( void )
+{
+    /* This just exists to keep the linker quiet. */
+}
+/*-----------------------------------------------------------*/
+
+#if ( configHEAP_ISR_BLOCK_COUNT > 0 )
+
+void * pvPortMallocFromISR( size_t xWantedSize )
+{
+    void * pvReturn = NULL;
+    void * pvNext;
+
+    if( ( xWantedSize > 0U ) && ( xWantedSize <= heapISR_BLOCK_SIZE ) )
+    {
+        /* Pop the first free block.  Every exception entry and return clears
+         * the exclusive monitor, so the store only fails if an interrupt ran
+         * between the load and the store, and the number of retries is bounded
+         * by the interrupt nesting depth. */
+        do
+        {
+            pvReturn = heapISR_LOAD_EXCLUSIVE( &ulISRFreeBlocks );
+
+            if( pvReturn == NULL )
+            {
+                heapISR_CLEAR_EXCLUSIVE();
+                break;
+            }
+
+            pvNext = heapISR_NEXT_FREE_BLOCK( pvReturn );
+        } while( heapISR_STORE_EXCLUSIVE( pvNext, &ulISRFreeBlocks ) != 0U );
+    }
+    else
+    {
+        mtCOVERAGE_TEST_MARKER();
+    }
+
+    return pvReturn;
+}
+/*-----------------------------------------------------------*/
+
+void vPortFreeFromISR( void * pv )
+{
+    void * pvHead;
+
+    if( pv != NULL )
+    {
+        configASSERT( ( ( uint8_t * ) pv >= pucISRBlocks ) && ( ( uint8_t * ) pv < pucISRBlocksEnd ) );
+        configASSERT( ( ( size_t ) ( ( uint8_t * ) pv - pucISRBlocks ) % heapISR_BLOCK_SIZE ) == 0U );
+
+        #if ( configHEAP_CLEAR_MEMORY_ON_FREE == 1 )
+        {
+            ( void ) memset( pv, 0, heapISR_BLOCK_SIZE );
+        }
+        #endif
+
+        /* Push the block back, retried like the pop in
+         * pvPortMallocFromISR(). */
+        do
+        {
+            pvHead = heapISR_LOAD_EXCLUSIVE( &ulISRFreeBlocks );
+            heapISR_NEXT_FREE_BLOCK( pv ) = pvHead;
+        } while( heapISR_STORE_EXCLUSIVE( pv, &ulISRFreeBlocks ) != 0U );
+    }
+    else
+    {
+        mtCOVERAGE_TEST_MARKER();
+    }
+}
+/*-----------------------------------------------------------*/
+
+#endif /* configHEAP_ISR_BLOCK_COUNT */
+
+void * pvPortCalloc( size_t xNum,
+                     size_t xSize )
+{
+    void * pv = NULL;
+
+    if( heapMULTIPLY_WILL_OVERFLOW( xNum, xSize ) == 0 )
+    {
+        /* When the free memory is kept zeroed prvMalloc() only has to clear
+         * the link area of a block from the free list(s), otherwise it clears
+         * the whole block. */
+        pv = prvMalloc( xNum * xSize, 0U, heapREQUEST_ZEROED );
+    }
+
+    return pv;
+}
+/*-----------------------------------------------------------*/
+
+void * pvPortRealloc( void * pv,
+                      size_t xWantedSize )
+{
+    BlockLink_t * pxLink;
+    void * pvReturn = NULL;
+    size_t xBlockSize;
+    size_t xOldSize = 0U;
+    BaseType_t xResized = pdFALSE;
+
+    #if ( configHEAP_PERF_COUNTERS == 1 )
+        uint32_t ulSuspendStart;
+    #endif
+
+    if( pv == NULL )
+    {
+        pvReturn = pvPortMalloc( xWantedSize );
+    }
+    else if( xWantedSize == 0U )
+    {
+        vPortFree( pv );
+    }
+    else
+    {
+        #if ( configHEAP_ISR_BLOCK_COUNT > 0 )
+        {
+            /* A block reserved for interrupts cannot change size. */
+            if( ( ( uint8_t * ) pv >= pucISRBlocks ) && ( ( uint8_t * ) pv < pucISRBlocksEnd ) )
+            {
+                xOldSize = heapISR_BLOCK_SIZE;
+            }
+            else
+            {
+                mtCOVERAGE_TEST_MARKER();
+            }
+        }
+        #endif /* configHEAP_ISR_BLOCK_COUNT */
+
+        #if ( configHEAP_USE_POOLS == 1 )
+        {
+            /* Neither can a pool object. */
+            if( xOldSize == 0U )
+            {
+                xOldSize = xPortPoolGetObjectSize( pv );
+            }
+            else
+            {
+                mtCOVERAGE_TEST_MARKER();
+            }
+        }
+        #endif /* configHEAP_USE_POOLS */
+
+        if( xOldSize == 0U )
+        {
+            /* The memory being resized will have an BlockLink_t structure
+             * immediately before it. */
+            pxLink = ( void * ) ( ( ( uint8_t * ) pv ) - xHeapStructSize );
+
+            heapVALIDATE_BLOCK_POINTER( pxLink );
+            configASSERT( heapBLOCK_IS_ALLOCATED( pxLink ) != 0 );
+            configASSERT( heapNEXT_FREE_BLOCK_IS_CLEAR( pxLink ) != pdFALSE );
+
+            xOldSize = ( pxLink->xBlockSize & ~heapBLOCK_ALLOCATED_BITMASK ) - xHeapStructSize - heapFOOTER_SIZE;
+            xBlockSize = prvGetBlockSize( xWantedSize );
+
+            if( ( xBlockSize > 0 ) && ( heapBLOCK_SIZE_IS_VALID( xBlockSize ) != 0 ) )
+            {
+                vTaskSuspendAll();
+                {
+                    heapPERF_TIMESTAMP( ulSuspendStart );
+                    xResized = prvResizeBlock( pxLink, xBlockSize );
+                    heapPERF_SUSPENDED_DONE( ulSuspendStart );
+                }
+                ( void ) xTaskResumeAll();
+            }
+            else
+            {
+                mtCOVERAGE_TEST_MARKER();
+            }
+        }
+        else if( xWantedSize <= xOldSize )
+        {
+            xResized = pdTRUE;
+        }
+        else
+        {
+            mtCOVERAGE_TEST_MARKER();
+        }
+
+        if( xResized != pdFALSE )
+        {
+            pvReturn = pv;
+        }
+        else
+        {
+            /* Move the data to a new block.  If there is no room for it pv is
+             * left untouched, as with realloc(). */
+            pvReturn = pvPortMalloc( xWantedSize );
+
+            if( pvReturn != NULL )
+            {
+                ( void ) memcpy( pvReturn, pv, ( xOldSize < xWantedSize ) ? xOldSize : xWantedSize );
+                vPortFree( pv );
+            }
+            else
+            {
+                mtCOVERAGE_TEST_MARKER();
+            }
+        }
+    }
+
+    return pvReturn;
+}
+/*-----------------------------------------------------------*/
+
+#if ( configHEAP_ALLOCATION_TYPE != 7 )
+
+void * pvPortMallocAligned( size_t xWantedSize,
+                            size_t xAlignment )
+{
+    void * pvReturn;
+
+    /* The alignment must be a power of two. */
+    configASSERT( ( xAlignment != 0U ) && ( ( xAlignment & ( xAlignment - 1U ) ) == 0U ) );
+
+    if( xAlignment <= ( size_t ) portBYTE_ALIGNMENT )
+    {
+        /* Every block is aligned that much already. */
+        pvReturn = pvPortMalloc( xWantedSize );
+    }
+    else
+    {
+        pvReturn = prvMalloc( xWantedSize, xAlignment, 0U );
+
+        configASSERT( ( ( ( portPOINTER_SIZE_TYPE ) pvReturn ) & ( ( portPOINTER_SIZE_TYPE ) xAlignment - 1U ) ) == 0U );
+    }
+
+    return pvReturn;
+}
+
+#endif /* configHEAP_ALLOCATION_TYPE != 7 */
+/*-----------------------------------------------------------*/
+
+void * pvPortMallocWithLifetime( size_t xWantedSize,
+                                 eHeapLifetime eLifetime )
+{
+    void * pvReturn;
+
+    if( eLifetime == eHeapLifetimeLong )
+    {
+        pvReturn = prvMalloc( xWantedSize, 0U, heapREQUEST_LONG_LIVED );
+    }
+    else
+    {
+        /* Transient blocks are placed by the allocation policy, which works
+         * from the low end of the heap. */
+        pvReturn = prvMalloc( xWantedSize, 0U, 0U );
+    }
+
+    return pvReturn;
+}
+/*-----------------------------------------------------------*/
+
+void vPortHeapIdleMaintenance( void )
+{
+    /* Only declared if one of the sections below is compiled in. */
+    #if ( configHEAP_PERF_COUNTERS == 1 ) &&                                                  \
+    ( ( configHEAP_FAST_BIN_COUNT > 0 ) || ( configHEAP_PREZERO_FREE_BLOCKS == 1 ) ||        \
+    ( configHEAP_DEFERRED_COALESCING == 1 ) ||                                              \
+    ( ( configHEAP_USE_HANDLES == 1 ) && ( configHEAP_ALLOCATION_TYPE != 7 ) ) )
+        uint32_t ulSuspendStart;
+    #endif
+
+    #if ( configHEAP_FAST_BIN_COUNT > 0 )
+    {
+        /* The burst the cached blocks were kept for is over, merge them back
+         * into the heap. */
+        vTaskSuspendAll();
+        {
+            heapPERF_TIMESTAMP( ulSuspendStart );
+            ( void ) prvFlushFastBins();
+            heapPERF_SUSPENDED_DONE( ulSuspendStart );
+        }
+        ( void ) xTaskResumeAll();
+    }
+    #endif /* configHEAP_FAST_BIN_COUNT */
+
+    #if ( configHEAP_PREZERO_FREE_BLOCKS == 1 )
+    {
+        /* Zeroing takes longer than merging, so the work is bounded in bytes
+         * rather than in blocks. */
+        vTaskSuspendAll();
+        {
+            heapPERF_TIMESTAMP( ulSuspendStart );
+            ( void ) prvScrubPendingFrees( ( size_t ) configHEAP_PREZERO_BYTES_PER_CALL );
+            heapPERF_SUSPENDED_DONE( ulSuspendStart );
+        }
+        ( void ) xTaskResumeAll();
+    }
+    #elif ( configHEAP_DEFERRED_COALESCING == 1 )
+    {
+        /* Only a batch of pending frees per call, so the scheduler is not
+         * held suspended for long.  The idle task calls again soon enough. */
+        vTaskSuspendAll();
+        {
+            heapPERF_TIMESTAMP( ulSuspendStart );
+            ( void ) prvMergePendingFrees( ( UBaseType_t ) configHEAP_DEFERRED_MERGE_BATCH );
+            heapPERF_SUSPENDED_DONE( ulSuspendStart );
+        }
+        ( void ) xTaskResumeAll();
+    }
+    #endif /* configHEAP_PREZERO_FREE_BLOCKS */
+
+    #if ( configHEAP_USE_HANDLES == 1 ) && ( configHEAP_ALLOCATION_TYPE != 7 )
+    {
+        /* Copying a block takes a while, so one block per call. */
+        vTaskSuspendAll();
+        {
+            heapPERF_TIMESTAMP( ulSuspendStart );
+            ( void ) prvCompactHeap( 1U );
+            heapPERF_SUSPENDED_DONE( ulSuspendStart );
+        }
+        ( void ) xTaskResumeAll();
+    }
+    #endif /* ( configHEAP_USE_HANDLES == 1 ) && ( configHEAP_ALLOCATION_TYPE != 7 ) */
+}
+/*-----------------------------------------------------------*/
+
+static size_t prvGetBlockSize( size_t xWantedSize ) /* PRIVILEGED_FUNCTION */
+{
+    size_t xAdditionalRequiredSize;
+
+    if( xWantedSize > 0 )
+    {
+        /* The wanted size must be increased so it can contain a BlockLink_t
+         * structure (and the footer, when boundary tags are in use) in
+         * addition to the requested amount of bytes. */
+        if( heapADD_WILL_OVERFLOW( xWantedSize, xHeapStructSize + heapFOOTER_SIZE ) == 0 )
+        {
+            xWantedSize += xHeapStructSize + heapFOOTER_SIZE;
+
+            /* Ensure that blocks are always aligned to the required number
+             * of bytes. */
+            if( ( xWantedSize & portBYTE_ALIGNMENT_MASK ) != 0x00 )
+            {
+                /* Byte alignment required. */
+                xAdditionalRequiredSize = portBYTE_ALIGNMENT - ( xWantedSize & portBYTE_ALIGNMENT_MASK );
+
+                if( heapADD_WILL_OVERFLOW( xWantedSize, xAdditionalRequiredSize ) == 0 )
+                {
+                    xWantedSize += xAdditionalRequiredSize;
+                }
+                else
+                {
+                    xWantedSize = 0;
+                }
+            }
+            else
+            {
+                mtCOVERAGE_TEST_MARKER();
+            }
+        }
+        else
+        {
+            xWantedSize = 0;
+        }
+
+        #if ( configHEAP_ALLOCATION_TYPE == 7 )
+        {
+            /* Buddy blocks are powers of two, and never smaller than
+             * heapMINIMUM_BLOCK_SIZE so a free block can hold its back link. */
+            if( ( xWantedSize > 0 ) && ( xWantedSize <= heapBUDDY_MAX_BLOCK_SIZE ) )
+            {
+                xWantedSize = ( ( size_t ) 1 ) << ( heapFLS( xWantedSize - 1U ) + 1U );
+
+                if( xWantedSize < heapMINIMUM_BLOCK_SIZE )
+                {
+                    xWantedSize = heapMINIMUM_BLOCK_SIZE;
+                }
+                else
+                {
+                    mtCOVERAGE_TEST_MARKER();
+                }
+            }
+            else
+            {
+                xWantedSize = 0;
+            }
+        }
+        #endif /* configHEAP_ALLOCATION_TYPE == 7 */
+
+        #if ( heapUSE_BEST_FIT_TREE == 1 )
+        {
+            /* The block must be able to hold a tree node once it is freed. */
+            if( ( xWantedSize > 0 ) && ( xWantedSize < heapMINIMUM_BLOCK_SIZE ) )
+            {
+                xWantedSize = heapMINIMUM_BLOCK_SIZE;
+            }
+            else
+            {
+                mtCOVERAGE_TEST_MARKER();
+            }
+        }
+        #endif /* heapUSE_BEST_FIT_TREE */
+    }
+    else
+    {
+        mtCOVERAGE_TEST_MARKER();
+    }
+
+    return xWantedSize;
+}
+/*-----------------------------------------------------------*/
+
+static BaseType_t prvResizeBlock( BlockLink_t * pxBlock,
+                                  size_t xWantedSize ) /* PRIVILEGED_FUNCTION */
+{
+    size_t xBlockSize = pxBlock->xBlockSize & ~heapBLOCK_ALLOCATED_BITMASK;
+    size_t xAvailableSize = xBlockSize;
+    BlockLink_t * pxTail;
+    BaseType_t xReturn = pdTRUE;
+
+    #if ( configHEAP_TASK_ACCOUNTING == 1 )
+        TaskHeapStats_t * pxOwner;
+    #endif
+
+    #if ( configHEAP_ALLOCATION_TYPE == 7 )
+        size_t xOffset = ( size_t ) ( ( ( uint8_t * ) pxBlock ) - pucBuddyHeapStart );
+        size_t xSize;
+    #else
+        BlockLink_t * pxNeighbour = NULL;
+
+        #if ( heapUSE_BOUNDARY_TAGS == 0 )
+            BlockLink_t * pxIterator = NULL;
+        #endif
+    #endif
+
+    if( xWantedSize > xBlockSize )
+    {
+        #if ( configHEAP_ALLOCATION_TYPE == 7 )
+        {
+            /* A buddy block can only grow while it is the lower half of the
+             * next size and its buddy is free and not split, that is when
+             * vPortFree() would merge the two.  At most one iteration per
+             * block size. */
+            while( ( xAvailableSize < xWantedSize ) &&
+                   ( xAvailableSize < heapBUDDY_MAX_BLOCK_SIZE ) &&
+                   ( ( xOffset & xAvailableSize ) == 0U ) &&
+                   ( ( xOffset + ( xAvailableSize << 1 ) ) <= xBuddyHeapSize ) &&
+                   ( heapBUDDY_BLOCK_AT( xOffset + xAvailableSize )->xBlockSize == xAvailableSize ) )
+            {
+                xAvailableSize <<= 1;
+            }
+        }
+        #elif ( heapUSE_BOUNDARY_TAGS == 1 )
+        {
+            /* The end marker is flagged as allocated, so the block physically
+             * after this one can always be inspected. */
+            pxNeighbour = ( void * ) ( ( ( uint8_t * ) pxBlock ) + xBlockSize );
+            heapVALIDATE_BLOCK_POINTER( pxNeighbour );
+
+            if( heapBLOCK_IS_ALLOCATED( pxNeighbour ) == 0 )
+            {
+                xAvailableSize += pxNeighbour->xBlockSize;
+            }
+            else
+            {
+                mtCOVERAGE_TEST_MARKER();
+            }
+        }
+        #else /* configHEAP_ALLOCATION_TYPE == 7 */
+        {
+            /* Find the first free block after this one in the address ordered
+             * list.  If it starts where this block ends they can be joined,
+             * unless it is an end marker, which has a size of 0. */
+            for( pxIterator = &xStart; heapPROTECT_BLOCK_POINTER( pxIterator->pxNextFreeBlock ) < pxBlock; pxIterator = heapPROTECT_BLOCK_POINTER( pxIterator->pxNextFreeBlock ) )
+            {
+                /* Nothing to do here, just iterate to the right position. */
+            }
+
+            pxNeighbour = heapPROTECT_BLOCK_POINTER( pxIterator->pxNextFreeBlock );
+
+            if( ( ( uint8_t * ) pxNeighbour ) == ( ( ( uint8_t * ) pxBlock ) + xBlockSize ) )
+            {
+                xAvailableSize += pxNeighbour->xBlockSize;
+            }
+            else
+            {
+                mtCOVERAGE_TEST_MARKER();
+            }
+        }
+        #endif /* configHEAP_ALLOCATION_TYPE == 7 */
+
+        /* With task accounting the block stays with its owner, whose quota
+         * must allow it to grow.  Otherwise it is moved, and charged to the
+         * caller. */
+        if( ( xAvailableSize < xWantedSize ) || ( heapTASK_QUOTA_ALLOWS( heapBLOCK_OWNER( pxBlock ), xWantedSize - xBlockSize ) == pdFALSE ) )
+        {
+            xReturn = pdFALSE;
+        }
+        else
+        {
+            mtCOVERAGE_TEST_MARKER();
+        }
+    }
+    else
+    {
+        mtCOVERAGE_TEST_MARKER();
+    }
+
+    if( xReturn != pdFALSE )
+    {
+        /* The block is accounted for as freed, then allocated again with its
+         * new size, as it would be if it had been moved. */
+        #if ( configHEAP_TASK_ACCOUNTING == 1 )
+            pxOwner = heapBLOCK_OWNER( pxBlock );
+        #endif
+
+        traceFREE( ( ( uint8_t * ) pxBlock ) + xHeapStructSize, xBlockSize );
+        heapREGION_FREED( pxBlock );
+        heapTASK_FREED( pxBlock );
+        xFreeBytesRemaining += xBlockSize;
+        xNumberOfSuccessfulFrees++;
+
+        #if ( configHEAP_ALLOCATION_TYPE == 7 )
+        {
+            /* Take the buddies in, then give back the upper halves that are
+             * not needed, as pvPortMalloc() does. */
+            for( xSize = xBlockSize; xSize < xAvailableSize; xSize <<= 1 )
+            {
+                prvUnlinkFreeBlock( heapBUDDY_BLOCK_AT( xOffset + xSize ) );
+            }
+
+            while( ( xAvailableSize >> 1 ) >= xWantedSize )
+            {
+                xAvailableSize >>= 1;
+                pxTail = heapBUDDY_BLOCK_AT( xOffset + xAvailableSize );
+                pxTail->xBlockSize = xAvailableSize;
+
+                /* An upper half inside the old block held data. */
+                if( xAvailableSize < xBlockSize )
+                {
+                    heapINSERT_DIRTY_BLOCK( pxTail );
+                }
+                else
+                {
+                    prvLinkFreeBlock( pxTail );
+                }
+            }
+
+            pxBlock->xBlockSize = xAvailableSize;
+            heapALLOCATE_BLOCK( pxBlock );
+        }
+        #else /* configHEAP_ALLOCATION_TYPE == 7 */
+        {
+            if( xAvailableSize > xBlockSize )
+            {
+                #if ( heapUSE_BOUNDARY_TAGS == 1 )
+                {
+                    prvUnlinkFreeBlock( pxNeighbour );
+                }
+                #else
+                {
+                    heapSTATS_REMOVE_FREE_BLOCK( pxNeighbour->xBlockSize );
+
+                    #if ( heapUSE_NEXT_FIT_ROVER == 1 )
                     {
-                        mtCOVERAGE_TEST_MARKER();
+                        /* The rover must not be left on the block that is
+                         * taken in. */
+                        if( pxNextFitRover == pxNeighbour )
+                        {
+                            pxNextFitRover = pxIterator;
+                        }
+                        else
+                        {
+                            mtCOVERAGE_TEST_MARKER();
+                        }
                     }
+                    #endif
+
+                    pxIterator->pxNextFreeBlock = pxNeighbour->pxNextFreeBlock;
+                }
+                #endif /* heapUSE_BOUNDARY_TAGS */
+            }
+            else
+            {
+                mtCOVERAGE_TEST_MARKER();
+            }
+
+            /* Split the tail off if it is large enough to be a block.  The
+             * block must look allocated before the tail is inserted, so the
+             * tail is not merged back into it. */
+            if( ( xAvailableSize - xWantedSize ) > heapMINIMUM_BLOCK_SIZE )
+            {
+                pxTail = ( void * ) ( ( ( uint8_t * ) pxBlock ) + xWantedSize );
+                configASSERT( ( ( ( size_t ) pxTail ) & portBYTE_ALIGNMENT_MASK ) == heapBLOCK_START_OFFSET );
+
+                pxTail->xBlockSize = xAvailableSize - xWantedSize;
+                pxBlock->xBlockSize = xWantedSize;
+                heapALLOCATE_BLOCK( pxBlock );
+                heapWRITE_FOOTER( pxBlock );
+
+                /* The tail of a block that shrinks held data. */
+                if( xWantedSize < xBlockSize )
+                {
+                    heapINSERT_DIRTY_BLOCK( pxTail );
+                }
+                else
+                {
+                    prvInsertBlockIntoFreeList( pxTail );
+                }
+            }
+            else
+            {
+                pxBlock->xBlockSize = xAvailableSize;
+                heapALLOCATE_BLOCK( pxBlock );
+                heapWRITE_FOOTER( pxBlock );
+            }
+        }
+        #endif /* configHEAP_ALLOCATION_TYPE == 7 */
+
+        xFreeBytesRemaining -= pxBlock->xBlockSize & ~heapBLOCK_ALLOCATED_BITMASK;
+        heapREGION_ALLOCATED( pxBlock );
+        heapTASK_ALLOCATED( pxBlock, pxOwner );
+
+        if( xFreeBytesRemaining < xMinimumEverFreeBytesRemaining )
+        {
+            xMinimumEverFreeBytesRemaining = xFreeBytesRemaining;
+        }
+        else
+        {
+            mtCOVERAGE_TEST_MARKER();
+        }
+
+        xNumberOfSuccessfulAllocations++;
+        traceMALLOC( ( ( uint8_t * ) pxBlock ) + xHeapStructSize, pxBlock->xBlockSize & ~heapBLOCK_ALLOCATED_BITMASK );
+    }
+    else
+    {
+        mtCOVERAGE_TEST_MARKER();
+    }
+
+    return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+#if ( configHEAP_ALLOCATION_TYPE != 7 )
+
+static BlockLink_t * prvSplitBlockHead( BlockLink_t * pxBlock,
+                                        size_t xWantedSize,
+                                        size_t xAlignment,
+                                        BlockLink_t ** ppxPreviousBlock ) /* PRIVILEGED_FUNCTION */
+{
+    BlockLink_t * pxRemainingBlock;
+    portPOINTER_SIZE_TYPE uxPayload;
+    size_t xGap = 0U;
+
+    if( xAlignment != 0U )
+    {
+        /* Distance to the first aligned payload.  The gap becomes a free block
+         * so it cannot be smaller than one, which prvMalloc() allowed for
+         * when it looked for a block of xWantedSize + xAlignment +
+         * heapMINIMUM_BLOCK_SIZE bytes.  The gap is a multiple of
+         * portBYTE_ALIGNMENT, so the aligned block starts on a block
+         * boundary. */
+        uxPayload = ( ( portPOINTER_SIZE_TYPE ) pxBlock ) + ( portPOINTER_SIZE_TYPE ) xHeapStructSize;
+        xGap = ( size_t ) ( ( ( portPOINTER_SIZE_TYPE ) 0U - uxPayload ) & ( ( portPOINTER_SIZE_TYPE ) xAlignment - 1U ) );
+
+        while( ( xGap != 0U ) && ( xGap < heapMINIMUM_BLOCK_SIZE ) )
+        {
+            xGap += xAlignment;
+        }
+    }
+    else if( ( pxBlock->xBlockSize - xWantedSize ) > heapMINIMUM_BLOCK_SIZE )
+    {
+        /* A long-lived block takes the top of the free block, and the rest
+         * stays free below it, on the side of the transient blocks. */
+        xGap = pxBlock->xBlockSize - xWantedSize;
+    }
+    else
+    {
+        mtCOVERAGE_TEST_MARKER();
+    }
+
+    if( xGap != 0U )
+    {
+        configASSERT( xGap < pxBlock->xBlockSize );
+
+        pxRemainingBlock = ( void * ) ( ( ( uint8_t * ) pxBlock ) + xGap );
+        pxRemainingBlock->xBlockSize = pxBlock->xBlockSize - xGap;
+        pxBlock->xBlockSize = xGap;
+
+        /* The block in front of the head is never free, otherwise it would
+         * have been merged with pxBlock, so the head is linked as it is. */
+        #if ( heapUSE_BOUNDARY_TAGS == 1 ) || ( heapUSE_SEGREGATED_LISTS == 1 )
+        {
+            ( void ) ppxPreviousBlock;
+            heapWRITE_FOOTER( pxBlock );
+            prvLinkFreeBlock( pxBlock );
+
+            #if ( heapUSE_NEXT_FIT_ROVER == 1 )
+            {
+                /* The head was pushed on the head of the list. */
+                pxNextFitRover = &xStart;
+            }
+            #endif
+        }
+        #else
+        {
+            heapSTATS_ADD_FREE_BLOCK( pxBlock->xBlockSize );
+            pxBlock->pxNextFreeBlock = ( *ppxPreviousBlock )->pxNextFreeBlock;
+            ( *ppxPreviousBlock )->pxNextFreeBlock = heapPROTECT_BLOCK_POINTER( pxBlock );
+            *ppxPreviousBlock = pxBlock;
+        }
+        #endif
+
+        pxBlock = pxRemainingBlock;
+    }
+    else
+    {
+        mtCOVERAGE_TEST_MARKER();
+    }
+
+    return pxBlock;
+}
+
+#endif /* configHEAP_ALLOCATION_TYPE != 7 */
+/*-----------------------------------------------------------*/
+
+#if ( configHEAP_FAST_BIN_COUNT > 0 )
+
+static BaseType_t prvPushFastBin( BlockLink_t * pxBlock ) /* PRIVILEGED_FUNCTION */
+{
+    BaseType_t xReturn = pdFALSE;
+    size_t xBin;
+
+    if( pxBlock->xBlockSize >= heapMINIMUM_BLOCK_SIZE )
+    {
+        xBin = ( pxBlock->xBlockSize - heapMINIMUM_BLOCK_SIZE ) / portBYTE_ALIGNMENT;
+
+        if( ( xBin < ( size_t ) configHEAP_FAST_BIN_COUNT ) && ( uxFastBinLength[ xBin ] < ( UBaseType_t ) configHEAP_FAST_BIN_DEPTH ) )
+        {
+            /* The block stays allocated as far as the rest of the heap is
+             * concerned.  Its footer, if any, still says so. */
+            heapALLOCATE_BLOCK( pxBlock );
+
+            if( uxFastBinLength[ xBin ] > 0U )
+            {
+                pxBlock->pxNextFreeBlock = pxFastBins[ xBin ];
+            }
+            else
+            {
+                pxBlock->pxNextFreeBlock = heapPROTECT_BLOCK_POINTER( heapCACHE_END );
+            }
+
+            pxFastBins[ xBin ] = heapPROTECT_BLOCK_POINTER( pxBlock );
+            uxFastBinLength[ xBin ]++;
+            xReturn = pdTRUE;
+        }
+        else
+        {
+            mtCOVERAGE_TEST_MARKER();
+        }
+    }
+    else
+    {
+        mtCOVERAGE_TEST_MARKER();
+    }
+
+    return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+static BlockLink_t * prvPopFastBin( size_t xBlockSize ) /* PRIVILEGED_FUNCTION */
+{
+    BlockLink_t * pxBlock = NULL;
+    size_t xBin;
+
+    if( xBlockSize >= heapMINIMUM_BLOCK_SIZE )
+    {
+        xBin = ( xBlockSize - heapMINIMUM_BLOCK_SIZE ) / portBYTE_ALIGNMENT;
+
+        if( ( xBin < ( size_t ) configHEAP_FAST_BIN_COUNT ) && ( uxFastBinLength[ xBin ] > 0U ) )
+        {
+            pxBlock = heapPROTECT_BLOCK_POINTER( pxFastBins[ xBin ] );
+            heapVALIDATE_BLOCK_POINTER( pxBlock );
+            configASSERT( pxBlock->xBlockSize == ( xBlockSize | heapBLOCK_ALLOCATED_BITMASK ) );
+
+            /* A pvPortMallocWithHint() request only takes the block if it lies
+             * where the request wants it. */
+            if( heapBLOCK_IN_PLACEMENT( pxBlock ) != pdFALSE )
+            {
+                pxFastBins[ xBin ] = pxBlock->pxNextFreeBlock;
+                uxFastBinLength[ xBin ]--;
+
+                /* Returned like a block found by a search, pvPortMalloc()
+                 * marks it allocated again. */
+                heapFREE_BLOCK( pxBlock );
+            }
+            else
+            {
+                pxBlock = NULL;
+            }
+        }
+        else
+        {
+            mtCOVERAGE_TEST_MARKER();
+        }
+    }
+    else
+    {
+        mtCOVERAGE_TEST_MARKER();
+    }
+
+    return pxBlock;
+}
+/*-----------------------------------------------------------*/
+
+static BaseType_t prvFlushFastBins( void ) /* PRIVILEGED_FUNCTION */
+{
+    BlockLink_t * pxBlock;
+    BaseType_t xReturn = pdFALSE;
+    size_t xBin;
+
+    /* At most configHEAP_FAST_BIN_COUNT * configHEAP_FAST_BIN_DEPTH blocks. */
+    for( xBin = 0U; xBin < ( size_t ) configHEAP_FAST_BIN_COUNT; xBin++ )
+    {
+        while( uxFastBinLength[ xBin ] > 0U )
+        {
+            pxBlock = heapPROTECT_BLOCK_POINTER( pxFastBins[ xBin ] );
+            heapVALIDATE_BLOCK_POINTER( pxBlock );
+            pxFastBins[ xBin ] = pxBlock->pxNextFreeBlock;
+            uxFastBinLength[ xBin ]--;
+
+            heapFREE_BLOCK( pxBlock );
+            heapINSERT_DIRTY_BLOCK( pxBlock );
+            xReturn = pdTRUE;
+        }
+    }
+
+    return xReturn;
+}
+
+#endif /* configHEAP_FAST_BIN_COUNT */
+/*-----------------------------------------------------------*/
+
+#if ( heapUSE_PENDING_FREES == 1 )
+
+static void prvDeferFree( BlockLink_t * pxBlock ) /* PRIVILEGED_FUNCTION */
+{
+    /* As in a fast bin, the block stays allocated until it is merged.  The
+     * tail split off a block by prvResizeBlock() needs its footer written. */
+    heapALLOCATE_BLOCK( pxBlock );
+    heapWRITE_FOOTER( pxBlock );
+
+    if( uxPendingFrees > 0U )
+    {
+        pxBlock->pxNextFreeBlock = pxPendingFrees;
+    }
+    else
+    {
+        pxBlock->pxNextFreeBlock = heapPROTECT_BLOCK_POINTER( heapCACHE_END );
+    }
+
+    pxPendingFrees = heapPROTECT_BLOCK_POINTER( pxBlock );
+    uxPendingFrees++;
+}
+
+#endif /* heapUSE_PENDING_FREES */
+/*-----------------------------------------------------------*/
+
+#if ( configHEAP_PREZERO_FREE_BLOCKS == 1 )
+
+static BaseType_t prvScrubPendingFrees( size_t xMaxBytes ) /* PRIVILEGED_FUNCTION */
+{
+    BaseType_t xReturn = pdFALSE;
+    size_t xEnd, xBytes;
+
+    while( ( ( pxScrubBlock != NULL ) || ( uxPendingFrees > 0U ) ) && ( xMaxBytes > 0U ) )
+    {
+        if( pxScrubBlock == NULL )
+        {
+            pxScrubBlock = heapPROTECT_BLOCK_POINTER( pxPendingFrees );
+            heapVALIDATE_BLOCK_POINTER( pxScrubBlock );
+            pxPendingFrees = pxScrubBlock->pxNextFreeBlock;
+            uxPendingFrees--;
+
+            /* The header and pxNextFreeBlock are left alone, the block still
+             * looks like a pending free to vPortFree(). */
+            xScrubOffset = ( xHeapStructSize > sizeof( BlockLink_t ) ) ? xHeapStructSize : sizeof( BlockLink_t );
+        }
+        else
+        {
+            mtCOVERAGE_TEST_MARKER();
+        }
+
+        /* The footer, if any, is rewritten when the block is inserted. */
+        xEnd = ( pxScrubBlock->xBlockSize & ~heapBLOCK_ALLOCATED_BITMASK ) - heapFOOTER_SIZE;
+        xBytes = ( xEnd > xScrubOffset ) ? ( xEnd - xScrubOffset ) : 0U;
+
+        if( xBytes > xMaxBytes )
+        {
+            xBytes = xMaxBytes;
+        }
+        else
+        {
+            mtCOVERAGE_TEST_MARKER();
+        }
+
+        ( void ) memset( ( ( uint8_t * ) pxScrubBlock ) + xScrubOffset, 0, xBytes );
+        xScrubOffset += xBytes;
+        xMaxBytes -= xBytes;
+
+        if( xScrubOffset >= xEnd )
+        {
+            heapFREE_BLOCK( pxScrubBlock );
+            prvInsertBlockIntoFreeList( pxScrubBlock );
+            pxScrubBlock = NULL;
+            xReturn = pdTRUE;
+        }
+        else
+        {
+            mtCOVERAGE_TEST_MARKER();
+        }
+    }
+
+    return xReturn;
+}
+
+#elif ( configHEAP_DEFERRED_COALESCING == 1 )
+
+static BaseType_t prvMergePendingFrees( UBaseType_t uxMaxBlocks ) /* PRIVILEGED_FUNCTION */
+{
+    BlockLink_t * pxBlock;
+    BaseType_t xReturn = pdFALSE;
+
+    while( ( uxPendingFrees > 0U ) && ( uxMaxBlocks > 0U ) )
+    {
+        pxBlock = heapPROTECT_BLOCK_POINTER( pxPendingFrees );
+        heapVALIDATE_BLOCK_POINTER( pxBlock );
+        pxPendingFrees = pxBlock->pxNextFreeBlock;
+        uxPendingFrees--;
+        uxMaxBlocks--;
+
+        heapFREE_BLOCK( pxBlock );
+        prvInsertBlockIntoFreeList( pxBlock );
+        xReturn = pdTRUE;
+    }
+
+    return xReturn;
+}
+
+#endif /* configHEAP_PREZERO_FREE_BLOCKS */
+/*-----------------------------------------------------------*/
+
+#if ( configHEAP_USE_HANDLES == 1 )
+
+HeapHandle_t xHeapHandleAlloc( size_t xWantedSize )
+{
+    HeapHandleEntry_t * pxHandle = NULL;
+    UBaseType_t uxHandle;
+
+    #if ( configHEAP_PERF_COUNTERS == 1 )
+        uint32_t ulSuspendStart;
+    #endif
+
+    vTaskSuspendAll();
+    {
+        heapPERF_TIMESTAMP( ulSuspendStart );
+
+        for( uxHandle = 0U; uxHandle < ( UBaseType_t ) configHEAP_MAX_HANDLES; uxHandle++ )
+        {
+            if( xHeapHandles[ uxHandle ].pvBlock == NULL )
+            {
+                pxHandle = &( xHeapHandles[ uxHandle ] );
+                break;
+            }
+            else
+            {
+                mtCOVERAGE_TEST_MARKER();
+            }
+        }
+
+        if( pxHandle != NULL )
+        {
+            pxHandle->pvBlock = prvMalloc( xWantedSize, 0U, heapREQUEST_RELOCATABLE );
+            pxHandle->uxLockCount = 0U;
+
+            if( pxHandle->pvBlock == NULL )
+            {
+                pxHandle = NULL;
+            }
+            else
+            {
+                mtCOVERAGE_TEST_MARKER();
+            }
+        }
+        else
+        {
+            mtCOVERAGE_TEST_MARKER();
+        }
+
+        heapPERF_SUSPENDED_DONE( ulSuspendStart );
+    }
+    ( void ) xTaskResumeAll();
+
+    return pxHandle;
+}
+/*-----------------------------------------------------------*/
+
+void vHeapHandleFree( HeapHandle_t xHandle )
+{
+    #if ( configHEAP_PERF_COUNTERS == 1 )
+        uint32_t ulSuspendStart;
+    #endif
+
+    if( xHandle != NULL )
+    {
+        heapVALIDATE_HANDLE( xHandle );
+        configASSERT( xHandle->uxLockCount == 0U );
+
+        /* The block must not move between being read and being freed. */
+        vTaskSuspendAll();
+        {
+            heapPERF_TIMESTAMP( ulSuspendStart );
+            vPortFree( xHandle->pvBlock );
+            xHandle->pvBlock = NULL;
+            heapPERF_SUSPENDED_DONE( ulSuspendStart );
+        }
+        ( void ) xTaskResumeAll();
+    }
+    else
+    {
+        mtCOVERAGE_TEST_MARKER();
+    }
+}
+/*-----------------------------------------------------------*/
+
+void * pvHeapHandleLock( HeapHandle_t xHandle )
+{
+    void * pvReturn;
+
+    heapVALIDATE_HANDLE( xHandle );
+
+    /* Blocks are only moved with the scheduler suspended, so never while
+     * this runs.  The critical section keeps the count right when two tasks
+     * lock the same handle. */
+    taskENTER_CRITICAL();
+    {
+        xHandle->uxLockCount++;
+        pvReturn = xHandle->pvBlock;
+    }
+    taskEXIT_CRITICAL();
+
+    return pvReturn;
+}
+/*-----------------------------------------------------------*/
+
+void vHeapHandleUnlock( HeapHandle_t xHandle )
+{
+    heapVALIDATE_HANDLE( xHandle );
+    configASSERT( xHandle->uxLockCount > 0U );
+
+    taskENTER_CRITICAL();
+    {
+        if( xHandle->uxLockCount > 0U )
+        {
+            xHandle->uxLockCount--;
+        }
+        else
+        {
+            mtCOVERAGE_TEST_MARKER();
+        }
+    }
+    taskEXIT_CRITICAL();
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xPortHeapCompact( void )
+{
+    BaseType_t xReturn;
+
+    #if ( configHEAP_PERF_COUNTERS == 1 )
+        uint32_t ulSuspendStart;
+    #endif
+
+    vTaskSuspendAll();
+    {
+        heapPERF_TIMESTAMP( ulSuspendStart );
+
+        /* Cached and pending blocks look allocated, so nothing could move
+         * into them. */
+        ( void ) heapFLUSH_FAST_BINS();
+        ( void ) heapMERGE_PENDING_FREES();
+        xReturn = heapCOMPACT_HEAP();
+        heapPERF_SUSPENDED_DONE( ulSuspendStart );
+    }
+    ( void ) xTaskResumeAll();
+
+    return xReturn;
+}
+
+#endif /* configHEAP_USE_HANDLES */
+/*-----------------------------------------------------------*/
+
+#if ( configHEAP_USE_HANDLES == 1 ) && ( configHEAP_ALLOCATION_TYPE != 7 )
+
+static BaseType_t prvMoveBlockDown( HeapHandleEntry_t * pxHandle ) /* PRIVILEGED_FUNCTION */
+{
+    BlockLink_t * pxBlock = ( void * ) ( ( ( uint8_t * ) pxHandle->pvBlock ) - xHeapStructSize );
+    size_t xBlockSize = pxBlock->xBlockSize & ~heapBLOCK_ALLOCATED_BITMASK;
+    BlockLink_t * pxFree = NULL;
+    BlockLink_t * pxTail;
+    size_t xFreeSize;
+    BaseType_t xReturn = pdFALSE;
+
+    #if ( heapUSE_BOUNDARY_TAGS == 0 )
+        BlockLink_t * pxIterator;
+        BlockLink_t * pxPrevious = &xStart;
+    #endif
+
+    heapVALIDATE_BLOCK_POINTER( pxBlock );
+    configASSERT( heapBLOCK_IS_ALLOCATED( pxBlock ) != 0 );
+
+    #if ( heapUSE_BOUNDARY_TAGS == 1 )
+    {
+        /* The footer in front of the block belongs to the block physically
+         * before it, which is free if the footer holds a valid size. */
+        xFreeSize = heapPREVIOUS_FOOTER( pxBlock );
+
+        if( heapBLOCK_SIZE_IS_VALID( xFreeSize ) != 0 )
+        {
+            pxFree = ( void * ) ( ( ( uint8_t * ) pxBlock ) - xFreeSize );
+            heapVALIDATE_BLOCK_POINTER( pxFree );
+            prvUnlinkFreeBlock( pxFree );
+        }
+        else
+        {
+            mtCOVERAGE_TEST_MARKER();
+        }
+    }
+    #else /* heapUSE_BOUNDARY_TAGS */
+    {
+        /* Find the last free block in front of this one in the address
+         * ordered list.  It is the block physically before this one if it
+         * ends where this one starts. */
+        for( pxIterator = &xStart; heapPROTECT_BLOCK_POINTER( pxIterator->pxNextFreeBlock ) < pxBlock; pxIterator = heapPROTECT_BLOCK_POINTER( pxIterator->pxNextFreeBlock ) )
+        {
+            pxPrevious = pxIterator;
+        }
+
+        if( ( pxIterator != &xStart ) && ( ( ( ( uint8_t * ) pxIterator ) + pxIterator->xBlockSize ) == ( uint8_t * ) pxBlock ) )
+        {
+            heapVALIDATE_BLOCK_POINTER( pxIterator );
+            pxFree = pxIterator;
+            xFreeSize = pxFree->xBlockSize;
+            heapSTATS_REMOVE_FREE_BLOCK( xFreeSize );
+
+            #if ( heapUSE_NEXT_FIT_ROVER == 1 )
+            {
+                /* The rover must not be left on the block that is taken. */
+                if( pxNextFitRover == pxFree )
+                {
+                    pxNextFitRover = pxPrevious;
+                }
+                else
+                {
+                    mtCOVERAGE_TEST_MARKER();
+                }
+            }
+            #endif
+
+            pxPrevious->pxNextFreeBlock = pxFree->pxNextFreeBlock;
+        }
+        else
+        {
+            mtCOVERAGE_TEST_MARKER();
+        }
+    }
+    #endif /* heapUSE_BOUNDARY_TAGS */
+
+    if( pxFree != NULL )
+    {
+        traceFREE( pxHandle->pvBlock, xBlockSize );
+
+        /* The header moves with the block, so the block stays allocated and
+         * keeps its owner and footer, if any.  The two may overlap. */
+        ( void ) memmove( ( void * ) pxFree, ( void * ) pxBlock, xBlockSize );
+
+        /* The free space is now above the block.  Part of it held data. */
+        pxTail = ( void * ) ( ( ( uint8_t * ) pxFree ) + xBlockSize );
+        pxTail->xBlockSize = xFreeSize;
+
+        #if ( configHEAP_CLEAR_MEMORY_ON_FREE == 1 ) && ( configHEAP_PREZERO_FREE_BLOCKS == 0 )
+        {
+            ( void ) memset( ( ( uint8_t * ) pxTail ) + xHeapStructSize, 0, xFreeSize - xHeapStructSize );
+        }
+        #endif
+
+        heapINSERT_DIRTY_BLOCK( pxTail );
+
+        pxHandle->pvBlock = ( void * ) ( ( ( uint8_t * ) pxFree ) + xHeapStructSize );
+        traceMALLOC( pxHandle->pvBlock, xBlockSize );
+        xReturn = pdTRUE;
+    }
+    else
+    {
+        mtCOVERAGE_TEST_MARKER();
+    }
+
+    return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+static BaseType_t prvCompactHeap( UBaseType_t uxMaxMoves ) /* PRIVILEGED_FUNCTION */
+{
+    HeapHandleEntry_t * pxHandle;
+    UBaseType_t uxHandle;
+    BaseType_t xMoved = pdTRUE;
+    BaseType_t xReturn = pdFALSE;
+
+    /* A move can free the space in front of another block, so passes are made
+     * until one moves nothing.  Blocks only ever move down, so this ends. */
+    while( ( xMoved != pdFALSE ) && ( uxMaxMoves > 0U ) )
+    {
+        xMoved = pdFALSE;
+
+        for( uxHandle = 0U; ( uxHandle < ( UBaseType_t ) configHEAP_MAX_HANDLES ) && ( uxMaxMoves > 0U ); uxHandle++ )
+        {
+            pxHandle = &( xHeapHandles[ uxHandle ] );
+
+            if( ( pxHandle->pvBlock != NULL ) && ( pxHandle->uxLockCount == 0U ) && ( prvMoveBlockDown( pxHandle ) != pdFALSE ) )
+            {
+                uxMaxMoves--;
+                xMoved = pdTRUE;
+                xReturn = pdTRUE;
+            }
+            else
+            {
+                mtCOVERAGE_TEST_MARKER();
+            }
+        }
+
+        /* When the free memory is kept zeroed the space left by the moves is
+         * only merged once it has been zeroed.  That is left to
+         * vPortHeapIdleMaintenance() once the budget is spent. */
+        if( ( xMoved != pdFALSE ) && ( uxMaxMoves > 0U ) )
+        {
+            ( void ) heapMERGE_PENDING_FREES();
+        }
+        else
+        {
+            mtCOVERAGE_TEST_MARKER();
+        }
+    }
+
+    return xReturn;
+}
+
+#endif /* ( configHEAP_USE_HANDLES == 1 ) && ( configHEAP_ALLOCATION_TYPE != 7 ) */
+/*-----------------------------------------------------------*/
+
+#if ( configHEAP_USE_REGIONS == 0 )
+
+static void prvHeapInit( void ) /* PRIVILEGED_FUNCTION */
+{
+    BlockLink_t * pxFirstFreeBlock;
+    portPOINTER_SIZE_TYPE uxStartAddress, uxEndAddress;
+    size_t xTotalHeapSize = heapTOTAL_SIZE;
+
+    /* Ensure the heap starts on a correctly aligned boundary. */
+    uxStartAddress = ( portPOINTER_SIZE_TYPE ) heapSTART_ADDRESS;
+
+    if( ( uxStartAddress & portBYTE_ALIGNMENT_MASK ) != 0 )
+    {
+        uxStartAddress += ( portBYTE_ALIGNMENT - 1 );
+        uxStartAddress &= ~( ( portPOINTER_SIZE_TYPE ) portBYTE_ALIGNMENT_MASK );
+        xTotalHeapSize -= ( size_t ) ( uxStartAddress - ( portPOINTER_SIZE_TYPE ) heapSTART_ADDRESS );
+    }
+
+    #if ( configHEAP_USE_LINKER_REGION == 1 ) && ( ( configHEAP_ALLOCATION_TYPE == 4 ) || ( heapUSE_BEST_FIT_TREE == 1 ) )
+    {
+        /* The TLSF index and the best-fit tree path only hold blocks smaller
+         * than 2 ^ configHEAP_MAX_BLOCK_SIZE_LOG2 bytes, while the size of the
+         * region is only known at link time.  Leave the rest unused. */
+        if( xTotalHeapSize >= ( ( ( size_t ) 1 ) << configHEAP_MAX_BLOCK_SIZE_LOG2 ) )
+        {
+            xTotalHeapSize = ( ( ( size_t ) 1 ) << configHEAP_MAX_BLOCK_SIZE_LOG2 ) - portBYTE_ALIGNMENT;
+        }
+        else
+        {
+            mtCOVERAGE_TEST_MARKER();
+        }
+    }
+    #endif
+
+    #if ( configENABLE_HEAP_PROTECTOR == 1 )
+    {
+        vApplicationGetRandomHeapCanary( &( xHeapCanary ) );
+    }
+    #endif
+
+    #if ( heapUSE_BOUNDARY_TAGS == 1 )
+    {
+        /* The first block has no block in front of it.  Start the heap with a
+         * footer that looks like the footer of an allocated block so the first
+         * block is never merged backwards. */
+        uxStartAddress += ( portPOINTER_SIZE_TYPE ) portBYTE_ALIGNMENT;
+        xTotalHeapSize -= ( size_t ) portBYTE_ALIGNMENT;
+        heapPREVIOUS_FOOTER( uxStartAddress ) = heapBLOCK_ALLOCATED_BITMASK;
+    }
+    #endif /* heapUSE_BOUNDARY_TAGS */
+
+    #if ( configHEAP_ISR_BLOCK_COUNT > 0 )
+    {
+        uint8_t * pucBlock;
+
+        /* Take the blocks reserved for interrupts from the top of the heap.
+         * They are threaded on their free stack before it is published, as an
+         * interrupt may already be calling pvPortMallocFromISR(). */
+        configASSERT( xTotalHeapSize > ( heapISR_RESERVED_SIZE + portBYTE_ALIGNMENT ) );
+        pucISRBlocks = ( uint8_t * ) ( ( uxStartAddress + ( portPOINTER_SIZE_TYPE ) ( xTotalHeapSize - heapISR_RESERVED_SIZE ) ) & ~( ( portPOINTER_SIZE_TYPE ) portBYTE_ALIGNMENT_MASK ) );
+        pucISRBlocksEnd = pucISRBlocks + heapISR_RESERVED_SIZE;
+        xTotalHeapSize = ( size_t ) ( ( portPOINTER_SIZE_TYPE ) pucISRBlocks - uxStartAddress );
+
+        heapISR_NEXT_FREE_BLOCK( pucISRBlocksEnd - heapISR_BLOCK_SIZE ) = NULL;
+
+        for( pucBlock = pucISRBlocks; pucBlock < ( pucISRBlocksEnd - heapISR_BLOCK_SIZE ); pucBlock += heapISR_BLOCK_SIZE )
+        {
+            heapISR_NEXT_FREE_BLOCK( pucBlock ) = ( void * ) ( pucBlock + heapISR_BLOCK_SIZE );
+        }
+
+        ulISRFreeBlocks = ( uint32_t ) pucISRBlocks;
+    }
+    #endif /* configHEAP_ISR_BLOCK_COUNT */
+
+    uxStartAddress += ( portPOINTER_SIZE_TYPE ) heapBLOCK_START_OFFSET;
+    xTotalHeapSize -= heapBLOCK_START_OFFSET;
+
+    #if ( configHEAP_PREZERO_FREE_BLOCKS == 1 ) && ( ( configHEAP_USE_LINKER_REGION == 1 ) || ( configAPPLICATION_ALLOCATED_HEAP == 1 ) )
+    {
+        /* The startup code zeroes ucHeap with the rest of .bss, but nothing
+         * is known of memory the heap does not define itself. */
+        ( void ) memset( ( void * ) uxStartAddress, 0, xTotalHeapSize );
+    }
+    #endif
+
+    /* xStart is used to hold a pointer to the first item in the list of free
+     * blocks.  The void cast is used to prevent compiler warnings. */
+    xStart.pxNextFreeBlock = ( void * ) heapPROTECT_BLOCK_POINTER( uxStartAddress );
+    xStart.xBlockSize = ( size_t ) 0;
+
+    /* pxEnd is used to mark the end of the list of free blocks and is inserted
+     * at the end of the heap space. */
+    uxEndAddress = heapEND_MARKER_ADDRESS( uxStartAddress, xTotalHeapSize );
+    pxEnd = ( BlockLink_t * ) uxEndAddress;
+    pxEnd->xBlockSize = 0;
+    pxEnd->pxNextFreeBlock = heapPROTECT_BLOCK_POINTER( NULL );
+
+    /* To start with there is a single free block that is sized to take up the
+     * entire heap space, minus the space taken by pxEnd. */
+    pxFirstFreeBlock = ( BlockLink_t * ) uxStartAddress;
+    pxFirstFreeBlock->xBlockSize = ( size_t ) ( uxEndAddress - ( portPOINTER_SIZE_TYPE ) pxFirstFreeBlock );
+    pxFirstFreeBlock->pxNextFreeBlock = heapPROTECT_BLOCK_POINTER( pxEnd );
+
+    #if ( heapUSE_BOUNDARY_TAGS == 1 )
+    {
+        /* The end marker is seen as an allocated block by the block in front
+         * of it, so it is never merged forwards either. */
+        heapALLOCATE_BLOCK( pxEnd );
+        heapWRITE_FOOTER( pxFirstFreeBlock );
+        xStart.pxNextFreeBlock = heapPROTECT_BLOCK_POINTER( pxEnd );
+
+        #if ( heapUSE_BEST_FIT_TREE == 1 )
+        {
+            heapTREE_STORE( &pxTreeRoot, NULL );
+        }
+        #endif
+
+        prvLinkFreeBlock( pxFirstFreeBlock );
+    }
+    #elif ( configHEAP_ALLOCATION_TYPE == 7 )
+    {
+        /* Cut the heap into the largest blocks possible, biggest first, so
+         * every block starts at a multiple of its size.  What is left once no
+         * block fits any more is not used. */
+        pucBuddyHeapStart = ( uint8_t * ) uxStartAddress;
+        xTotalHeapSize = ( size_t ) ( uxEndAddress - uxStartAddress );
+        xBuddyHeapSize = 0U;
+
+        while( xTotalHeapSize >= heapMINIMUM_BLOCK_SIZE )
+        {
+            pxFirstFreeBlock = heapBUDDY_BLOCK_AT( xBuddyHeapSize );
+            pxFirstFreeBlock->xBlockSize = ( ( size_t ) 1 ) << heapFLS( xTotalHeapSize );
+
+            if( pxFirstFreeBlock->xBlockSize > heapBUDDY_MAX_BLOCK_SIZE )
+            {
+                pxFirstFreeBlock->xBlockSize = heapBUDDY_MAX_BLOCK_SIZE;
+            }
+            else
+            {
+                mtCOVERAGE_TEST_MARKER();
+            }
+
+            prvLinkFreeBlock( pxFirstFreeBlock );
+            xBuddyHeapSize += pxFirstFreeBlock->xBlockSize;
+            xTotalHeapSize -= pxFirstFreeBlock->xBlockSize;
+        }
+    }
+    #else
+    {
+        heapSTATS_ADD_FREE_BLOCK( pxFirstFreeBlock->xBlockSize );
+    }
+    #endif /* heapUSE_BOUNDARY_TAGS */
+
+    #if ( heapUSE_NEXT_FIT_ROVER == 1 )
+    {
+        pxNextFitRover = &xStart;
+    }
+    #endif
+
+    #if ( configHEAP_ALLOCATION_TYPE == 7 )
+    {
+        xMinimumEverFreeBytesRemaining = xBuddyHeapSize;
+        xFreeBytesRemaining = xBuddyHeapSize;
+    }
+    #else
+    {
+        /* Only one block exists - and it covers the entire usable heap space. */
+        xMinimumEverFreeBytesRemaining = pxFirstFreeBlock->xBlockSize;
+        xFreeBytesRemaining = pxFirstFreeBlock->xBlockSize;
+    }
+    #endif
+}
+/*-----------------------------------------------------------*/
+
+#else /* configHEAP_USE_REGIONS */
+
+void vPortDefineHeapRegions( const HeapRegion_t * const pxHeapRegions ) /* PRIVILEGED_FUNCTION */
+{
+    BlockLink_t * pxFirstFreeBlockInRegion;
+    BlockLink_t * pxPreviousFreeBlock;
+    portPOINTER_SIZE_TYPE uxAlignedHeap, uxAddress;
+    size_t xTotalRegionSize, xTotalHeapSize = 0;
+    const HeapRegion_t * pxHeapRegion;
+    HeapRegionStats_t * pxRegionStats;
+
+    /* Can only call once! */
+    configASSERT( pxEnd == NULL );
+
+    #if ( configENABLE_HEAP_PROTECTOR == 1 )
+    {
+        vApplicationGetRandomHeapCanary( &( xHeapCanary ) );
+    }
+    #endif
+
+    pxHeapRegion = &( pxHeapRegions[ uxNumberOfRegions ] );
+
+    while( pxHeapRegion->xSizeInBytes > 0 )
+    {
+        configASSERT( uxNumberOfRegions < ( UBaseType_t ) configHEAP_MAX_REGIONS );
+        xTotalRegionSize = pxHeapRegion->xSizeInBytes;
+
+        /* Ensure the heap region starts on a correctly aligned boundary. */
+        uxAddress = ( portPOINTER_SIZE_TYPE ) pxHeapRegion->pucStartAddress;
+
+        if( ( uxAddress & portBYTE_ALIGNMENT_MASK ) != 0 )
+        {
+            uxAddress += ( portBYTE_ALIGNMENT - 1 );
+            uxAddress &= ~( ( portPOINTER_SIZE_TYPE ) portBYTE_ALIGNMENT_MASK );
+
+            /* Adjust the size for the bytes lost to alignment. */
+            xTotalRegionSize -= ( size_t ) ( uxAddress - ( portPOINTER_SIZE_TYPE ) pxHeapRegion->pucStartAddress );
+        }
+
+        uxAlignedHeap = uxAddress + ( portPOINTER_SIZE_TYPE ) heapBLOCK_START_OFFSET;
+        xTotalRegionSize -= heapBLOCK_START_OFFSET;
+
+        #if ( configHEAP_PREZERO_FREE_BLOCKS == 1 )
+        {
+            /* The free memory must start zeroed. */
+            ( void ) memset( ( void * ) uxAlignedHeap, 0, xTotalRegionSize );
+        }
+        #endif
+
+        /* Set xStart if it has not already been set. */
+        if( uxNumberOfRegions == 0U )
+        {
+            /* xStart is used to hold a pointer to the first item in the list of
+             * free blocks.  The void cast is used to prevent compiler warnings. */
+            xStart.pxNextFreeBlock = ( void * ) heapPROTECT_BLOCK_POINTER( uxAlignedHeap );
+            xStart.xBlockSize = ( size_t ) 0;
+            pucHeapLowAddress = ( uint8_t * ) uxAlignedHeap;
+        }
+        else
+        {
+            /* Should only get here if one region has already been added to the
+             * heap, and the regions must be passed in order of increasing start
+             * address. */
+            configASSERT( pxEnd != NULL );
+            configASSERT( uxAddress > ( portPOINTER_SIZE_TYPE ) pxEnd );
+        }
+
+        /* Remember the location of the end marker in the previous region, if
+         * any. */
+        pxPreviousFreeBlock = pxEnd;
+
+        /* pxEnd is used to mark the end of the list of free blocks and is
+         * inserted at the end of the region space. */
+        uxAddress = heapEND_MARKER_ADDRESS( uxAlignedHeap, xTotalRegionSize );
+        pxEnd = ( BlockLink_t * ) uxAddress;
+        pxEnd->xBlockSize = 0;
+        pxEnd->pxNextFreeBlock = heapPROTECT_BLOCK_POINTER( NULL );
+
+        /* To start with there is a single free block in this region that is
+         * sized to take up the entire heap region minus the space taken by the
+         * end marker. */
+        pxFirstFreeBlockInRegion = ( BlockLink_t * ) uxAlignedHeap;
+        pxFirstFreeBlockInRegion->xBlockSize = ( size_t ) ( uxAddress - ( portPOINTER_SIZE_TYPE ) pxFirstFreeBlockInRegion );
+        pxFirstFreeBlockInRegion->pxNextFreeBlock = heapPROTECT_BLOCK_POINTER( pxEnd );
+        heapSTATS_ADD_FREE_BLOCK( pxFirstFreeBlockInRegion->xBlockSize );
+
+        /* If this is not the first region that makes up the entire heap space
+         * then link the previous region to this region. */
+        if( pxPreviousFreeBlock != NULL )
+        {
+            pxPreviousFreeBlock->pxNextFreeBlock = heapPROTECT_BLOCK_POINTER( pxFirstFreeBlockInRegion );
+        }
+        else
+        {
+            mtCOVERAGE_TEST_MARKER();
+        }
+
+        pxRegionStats = &( xRegionStats[ uxNumberOfRegions ] );
+        pxRegionStats->pucStartAddress = ( uint8_t * ) pxFirstFreeBlockInRegion;
+        pxRegionStats->xSizeInBytes = pxFirstFreeBlockInRegion->xBlockSize;
+        pxRegionStats->xAvailableHeapSpaceInBytes = pxFirstFreeBlockInRegion->xBlockSize;
+        pxRegionStats->xMinimumEverFreeBytesRemaining = pxFirstFreeBlockInRegion->xBlockSize;
+        pxRegionStats->xNumberOfSuccessfulAllocations = 0U;
+        pxRegionStats->xNumberOfSuccessfulFrees = 0U;
+
+        xTotalHeapSize += pxFirstFreeBlockInRegion->xBlockSize;
+
+        /* Move onto the next HeapRegion_t structure. */
+        uxNumberOfRegions++;
+        pxHeapRegion = &( pxHeapRegions[ uxNumberOfRegions ] );
+    }
+
+    /* Check something was actually defined before it is accessed. */
+    configASSERT( xTotalHeapSize );
+
+    pucHeapHighAddress = ( ( uint8_t * ) pxEnd ) + heapEND_MARKER_SIZE;
+
+    #if ( heapUSE_NEXT_FIT_ROVER == 1 )
+    {
+        pxNextFitRover = &xStart;
+    }
+    #endif
+
+    xMinimumEverFreeBytesRemaining = xTotalHeapSize;
+    xFreeBytesRemaining = xTotalHeapSize;
+}
+/*-----------------------------------------------------------*/
+
+void * pvPortMallocWithHint( size_t xWantedSize,
+                             eHeapPlacementHint eHint )
+{
+    UBaseType_t uxFlags = 0U;
+
+    /* Fast requests look inside the fast region first, bulk requests outside
+     * of it. */
+    if( eHint == eHeapHintFast )
+    {
+        uxFlags = heapREQUEST_FAST;
+    }
+    else if( eHint == eHeapHintBulk )
+    {
+        uxFlags = heapREQUEST_BULK;
+    }
+    else
+    {
+        mtCOVERAGE_TEST_MARKER();
+    }
+
+    return prvMalloc( xWantedSize, 0U, uxFlags );
+}
+/*-----------------------------------------------------------*/
+
+static BaseType_t prvWidenPlacement( void ) /* PRIVILEGED_FUNCTION */
+{
+    BaseType_t xReturn = pdFALSE;
+
+    if( ( pucPlacementStart != pucPlacementEnd ) || ( xPlacementInside != pdFALSE ) )
+    {
+        pucPlacementStart = NULL;
+        pucPlacementEnd = NULL;
+        xPlacementInside = pdFALSE;
+        xReturn = pdTRUE;
+    }
+    else
+    {
+        mtCOVERAGE_TEST_MARKER();
+    }
+
+    return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+static void prvUpdateRegionStats( const BlockLink_t * pxBlock,
+                                  BaseType_t xAllocated ) /* PRIVILEGED_FUNCTION */
+{
+    HeapRegionStats_t * pxRegionStats;
+    UBaseType_t uxRegion;
+    size_t xBlockSize = pxBlock->xBlockSize & ~heapBLOCK_ALLOCATED_BITMASK;
+
+    /* At most configHEAP_MAX_REGIONS iterations. */
+    for( uxRegion = 0U; uxRegion < uxNumberOfRegions; uxRegion++ )
+    {
+        pxRegionStats = &( xRegionStats[ uxRegion ] );
+
+        if( ( ( const uint8_t * ) pxBlock >= pxRegionStats->pucStartAddress ) &&
+            ( ( const uint8_t * ) pxBlock < ( pxRegionStats->pucStartAddress + pxRegionStats->xSizeInBytes ) ) )
+        {
+            if( xAllocated != pdFALSE )
+            {
+                pxRegionStats->xAvailableHeapSpaceInBytes -= xBlockSize;
+                pxRegionStats->xNumberOfSuccessfulAllocations++;
+
+                if( pxRegionStats->xAvailableHeapSpaceInBytes < pxRegionStats->xMinimumEverFreeBytesRemaining )
+                {
+                    pxRegionStats->xMinimumEverFreeBytesRemaining = pxRegionStats->xAvailableHeapSpaceInBytes;
+                }
+                else
+                {
+                    mtCOVERAGE_TEST_MARKER();
+                }
+            }
+            else
+            {
+                pxRegionStats->xAvailableHeapSpaceInBytes += xBlockSize;
+                pxRegionStats->xNumberOfSuccessfulFrees++;
+            }
+
+            break;
+        }
+        else
+        {
+            mtCOVERAGE_TEST_MARKER();
+        }
+    }
+}
+/*-----------------------------------------------------------*/
+
+UBaseType_t uxPortGetNumberOfHeapRegions( void )
+{
+    return uxNumberOfRegions;
+}
+/*-----------------------------------------------------------*/
+
+void vPortGetHeapRegionStats( UBaseType_t uxRegion,
+                              HeapRegionStats_t * pxRegionStats )
+{
+    configASSERT( uxRegion < uxNumberOfRegions );
+
+    taskENTER_CRITICAL();
+    {
+        *pxRegionStats = xRegionStats[ uxRegion ];
+    }
+    taskEXIT_CRITICAL();
+}
+/*-----------------------------------------------------------*/
+
+#endif /* configHEAP_USE_REGIONS */
+
+#if ( configHEAP_TASK_ACCOUNTING == 1 )
+
+static TaskHeapStats_t * prvGetTaskEntry( TaskHandle_t xTask ) /* PRIVILEGED_FUNCTION */
+{
+    TaskHeapStats_t * pxEntry = &( xTaskHeapStats[ 0 ] );
+    TaskHeapStats_t * pxFreeEntry = NULL;
+    UBaseType_t uxEntry;
+
+    if( xTask != NULL )
+    {
+        /* At most configHEAP_MAX_ACCOUNTED_TASKS - 1 iterations.  If xTask has
+         * no entry yet it takes a free one, or else one of a task that holds
+         * nothing and has no quota, so it is not missed. */
+        for( uxEntry = 1U; uxEntry < ( UBaseType_t ) configHEAP_MAX_ACCOUNTED_TASKS; uxEntry++ )
+        {
+            if( xTaskHeapStats[ uxEntry ].xHandle == xTask )
+            {
+                pxEntry = &( xTaskHeapStats[ uxEntry ] );
+                pxFreeEntry = NULL;
+                break;
+            }
+            else if( ( xTaskHeapStats[ uxEntry ].xCurrentBytes == 0U ) && ( xTaskHeapStats[ uxEntry ].xQuotaBytes == 0U ) &&
+                     ( ( pxFreeEntry == NULL ) || ( pxFreeEntry->xHandle != NULL ) ) )
+            {
+                pxFreeEntry = &( xTaskHeapStats[ uxEntry ] );
+            }
+            else
+            {
+                mtCOVERAGE_TEST_MARKER();
+            }
+        }
+
+        if( pxFreeEntry != NULL )
+        {
+            ( void ) memset( pxFreeEntry, 0x00, sizeof( TaskHeapStats_t ) );
+            pxFreeEntry->xHandle = xTask;
+            pxEntry = pxFreeEntry;
+        }
+        else
+        {
+            mtCOVERAGE_TEST_MARKER();
+        }
+    }
+    else
+    {
+        mtCOVERAGE_TEST_MARKER();
+    }
+
+    return pxEntry;
+}
+/*-----------------------------------------------------------*/
+
+static TaskHeapStats_t * prvGetCallerEntry( void ) /* PRIVILEGED_FUNCTION */
+{
+    TaskHeapStats_t * pxEntry;
+
+    /* Before the scheduler starts the current task handle may already be set
+     * to a task that has not run yet. */
+    if( xTaskGetSchedulerState() != taskSCHEDULER_NOT_STARTED )
+    {
+        pxEntry = prvGetTaskEntry( xTaskGetCurrentTaskHandle() );
+    }
+    else
+    {
+        pxEntry = prvGetTaskEntry( NULL );
+    }
+
+    return pxEntry;
+}
+/*-----------------------------------------------------------*/
+
+static size_t prvTaskQuotaLeft( const TaskHeapStats_t * pxEntry ) /* PRIVILEGED_FUNCTION */
+{
+    size_t xReturn = heapSIZE_MAX;
+
+    if( pxEntry->xQuotaBytes != 0U )
+    {
+        /* The quota may have been set below what the task already holds. */
+        if( pxEntry->xCurrentBytes >= pxEntry->xQuotaBytes )
+        {
+            xReturn = 0U;
+        }
+        else
+        {
+            xReturn = pxEntry->xQuotaBytes - pxEntry->xCurrentBytes;
+        }
+    }
+    else
+    {
+        mtCOVERAGE_TEST_MARKER();
+    }
+
+    return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+static BaseType_t prvTaskQuotaAllows( const TaskHeapStats_t * pxEntry,
+                                      size_t xSize ) /* PRIVILEGED_FUNCTION */
+{
+    BaseType_t xReturn = pdTRUE;
+
+    if( xSize > prvTaskQuotaLeft( pxEntry ) )
+    {
+        xReturn = pdFALSE;
+    }
+    else
+    {
+        mtCOVERAGE_TEST_MARKER();
+    }
+
+    return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+static void prvUpdateTaskStats( BlockLink_t * pxBlock,
+                                TaskHeapStats_t * pxOwner,
+                                BaseType_t xAllocated ) /* PRIVILEGED_FUNCTION */
+{
+    if( xAllocated != pdFALSE )
+    {
+        pxBlock->pxNextFreeBlock = ( void * ) pxOwner;
+    }
+    else
+    {
+        mtCOVERAGE_TEST_MARKER();
+    }
+
+    prvUpdateTaskBytes( pxOwner, pxBlock->xBlockSize & ~heapBLOCK_ALLOCATED_BITMASK, xAllocated );
+}
+/*-----------------------------------------------------------*/
+
+static void prvUpdateTaskBytes( TaskHeapStats_t * pxOwner,
+                                size_t xSize,
+                                BaseType_t xAllocated ) /* PRIVILEGED_FUNCTION */
+{
+    if( xAllocated != pdFALSE )
+    {
+        pxOwner->xCurrentBytes += xSize;
+        pxOwner->xNumberOfSuccessfulAllocations++;
+
+        if( pxOwner->xCurrentBytes > pxOwner->xPeakBytes )
+        {
+            pxOwner->xPeakBytes = pxOwner->xCurrentBytes;
+        }
+        else
+        {
+            mtCOVERAGE_TEST_MARKER();
+        }
+    }
+    else
+    {
+        configASSERT( pxOwner->xCurrentBytes >= xSize );
+        pxOwner->xCurrentBytes -= xSize;
+        pxOwner->xNumberOfSuccessfulFrees++;
+
+        if( ( pxOwner->xCurrentBytes == 0U ) && ( pxOwner->xHandle == NULL ) && ( pxOwner != &( xTaskHeapStats[ 0 ] ) ) )
+        {
+            /* The last block left by a deleted task, see
+             * vPortReleaseTaskHeapStats(). */
+            ( void ) memset( pxOwner, 0x00, sizeof( TaskHeapStats_t ) );
+        }
+        else
+        {
+            mtCOVERAGE_TEST_MARKER();
+        }
+    }
+}
+/*-----------------------------------------------------------*/
+
+#if ( configHEAP_USE_POOLS == 1 )
+
+static void * prvPoolMalloc( size_t xWantedSize ) /* PRIVILEGED_FUNCTION */
+{
+    void * pvReturn;
+    TaskHeapStats_t * pxOwner;
+
+    vTaskSuspendAll();
+    {
+        /* An object that would take the task over its quota is not taken, the
+         * heap then fails the request and counts the quota failure. */
+        pxOwner = prvGetCallerEntry();
+        pvReturn = pvPortPoolMalloc( xWantedSize, prvTaskQuotaLeft( pxOwner ) );
+
+        if( pvReturn != NULL )
+        {
+            *( ppvPortPoolGetOwner( pvReturn ) ) = ( void * ) pxOwner;
+            prvUpdateTaskBytes( pxOwner, xPortPoolGetObjectSize( pvReturn ), pdTRUE );
+        }
+        else
+        {
+            mtCOVERAGE_TEST_MARKER();
+        }
+    }
+    ( void ) xTaskResumeAll();
+
+    return pvReturn;
+}
+/*-----------------------------------------------------------*/
+
+static BaseType_t prvPoolFree( void * pv ) /* PRIVILEGED_FUNCTION */
+{
+    void ** ppvOwner;
+    BaseType_t xReturn = pdFALSE;
+
+    vTaskSuspendAll();
+    {
+        ppvOwner = ppvPortPoolGetOwner( pv );
+
+        if( ppvOwner != NULL )
+        {
+            prvUpdateTaskBytes( ( TaskHeapStats_t * ) *ppvOwner, xPortPoolGetObjectSize( pv ), pdFALSE );
+            *ppvOwner = NULL;
+            xReturn = xPortPoolFree( pv );
+        }
+        else
+        {
+            mtCOVERAGE_TEST_MARKER();
+        }
+    }
+    ( void ) xTaskResumeAll();
+
+    return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+#endif /* configHEAP_USE_POOLS */
+
+BaseType_t xPortSetTaskHeapQuota( TaskHandle_t xTask,
+                                  size_t xQuotaBytes )
+{
+    TaskHeapStats_t * pxEntry;
+    BaseType_t xReturn = pdFAIL;
+
+    if( xTask == NULL )
+    {
+        xTask = xTaskGetCurrentTaskHandle();
+    }
+    else
+    {
+        mtCOVERAGE_TEST_MARKER();
+    }
+
+    vTaskSuspendAll();
+    {
+        pxEntry = prvGetTaskEntry( xTask );
+
+        if( pxEntry != &( xTaskHeapStats[ 0 ] ) )
+        {
+            pxEntry->xQuotaBytes = xQuotaBytes;
+            xReturn = pdPASS;
+        }
+        else
+        {
+            mtCOVERAGE_TEST_MARKER();
+        }
+    }
+    ( void ) xTaskResumeAll();
+
+    return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+void vPortReleaseTaskHeapStats( TaskHandle_t xTask )
+{
+    UBaseType_t uxEntry;
+
+    /* Called from traceTASK_DELETE(), inside the critical section of
+     * vTaskDelete(), so the scheduler cannot be suspended here. */
+    taskENTER_CRITICAL();
+    {
+        for( uxEntry = 1U; uxEntry < ( UBaseType_t ) configHEAP_MAX_ACCOUNTED_TASKS; uxEntry++ )
+        {
+            if( xTaskHeapStats[ uxEntry ].xHandle == xTask )
+            {
+                if( xTaskHeapStats[ uxEntry ].xCurrentBytes == 0U )
+                {
+                    ( void ) memset( &( xTaskHeapStats[ uxEntry ] ), 0x00, sizeof( TaskHeapStats_t ) );
+                }
+                else
+                {
+                    /* The blocks the task leaked still point to the entry, so
+                     * it is kept until they are freed, but no new task of the
+                     * same TCB address can find it again. */
+                    xTaskHeapStats[ uxEntry ].xHandle = NULL;
+                    xTaskHeapStats[ uxEntry ].xQuotaBytes = 0U;
+                }
+
+                break;
+            }
+            else
+            {
+                mtCOVERAGE_TEST_MARKER();
+            }
+        }
+    }
+    taskEXIT_CRITICAL();
+}
+/*-----------------------------------------------------------*/
+
+UBaseType_t uxPortGetTaskHeapStats( TaskHeapStats_t * const pxTaskHeapStatsArray,
+                                    const UBaseType_t uxArraySize )
+{
+    UBaseType_t uxEntry, uxCount = 0U;
+
+    vTaskSuspendAll();
+    {
+        /* Count the entries in use first, so a short array gets nothing. */
+        for( uxEntry = 0U; uxEntry < ( UBaseType_t ) configHEAP_MAX_ACCOUNTED_TASKS; uxEntry++ )
+        {
+            if( ( xTaskHeapStats[ uxEntry ].xHandle != NULL ) || ( xTaskHeapStats[ uxEntry ].xNumberOfSuccessfulAllocations != 0U ) )
+            {
+                uxCount++;
+            }
+            else
+            {
+                mtCOVERAGE_TEST_MARKER();
+            }
+        }
+
+        if( uxCount <= uxArraySize )
+        {
+            uxCount = 0U;
+
+            for( uxEntry = 0U; uxEntry < ( UBaseType_t ) configHEAP_MAX_ACCOUNTED_TASKS; uxEntry++ )
+            {
+                if( ( xTaskHeapStats[ uxEntry ].xHandle != NULL ) || ( xTaskHeapStats[ uxEntry ].xNumberOfSuccessfulAllocations != 0U ) )
+                {
+                    pxTaskHeapStatsArray[ uxCount ] = xTaskHeapStats[ uxEntry ];
+                    uxCount++;
+                }
+                else
+                {
+                    mtCOVERAGE_TEST_MARKER();
+                }
+            }
+        }
+        else
+        {
+            uxCount = 0U;
+        }
+    }
+    ( void ) xTaskResumeAll();
+
+    return uxCount;
+}
+/*-----------------------------------------------------------*/
+
+#endif /* configHEAP_TASK_ACCOUNTING */
+
+#if ( heapUSE_INDEXED_FREE_BLOCKS == 0 )
+
+static BlockLink_t * prvSearchFreeList( size_t xWantedSize,
+                                        UBaseType_t uxFlags,
+                                        BlockLink_t ** ppxPreviousBlock ) /* PRIVILEGED_FUNCTION */
+{
+    BlockLink_t * pxBlock;
+
+    if( ( uxFlags & heapREQUEST_LONG_LIVED ) != 0U )
+    {
+        /* Long-lived blocks come from the high end of the heap whatever the
+         * policy, see pvPortMallocWithLifetime(). */
+        pxBlock = prvHighestFit( xWantedSize, ppxPreviousBlock );
+    }
+    else
+    {
+        #if ( configHEAP_ALLOCATION_TYPE == 8 )
+        {
+            switch( eAllocationPolicy )
+            {
+                case eHeapPolicyBestFit:
+                    pxBlock = prvBestFit( xWantedSize, ppxPreviousBlock );
+                    break;
+
+                case eHeapPolicyWorstFit:
+                    pxBlock = prvWorstFit( xWantedSize, ppxPreviousBlock );
+                    break;
+
+                case eHeapPolicyNextFit:
+                    pxBlock = prvNextFit( xWantedSize, ppxPreviousBlock );
+                    break;
+
+                default:
+                    pxBlock = prvFirstFit( xWantedSize, ppxPreviousBlock );
+                    break;
+            }
+        }
+        #elif ( configHEAP_ALLOCATION_TYPE == 1 )
+        {
+            pxBlock = prvBestFit( xWantedSize, ppxPreviousBlock );
+        }
+        #elif ( configHEAP_ALLOCATION_TYPE == 2 )
+        {
+            pxBlock = prvWorstFit( xWantedSize, ppxPreviousBlock );
+        }
+        #elif ( configHEAP_ALLOCATION_TYPE == 6 )
+        {
+            pxBlock = prvNextFit( xWantedSize, ppxPreviousBlock );
+        }
+        #else
+        {
+            pxBlock = prvFirstFit( xWantedSize, ppxPreviousBlock );
+        }
+        #endif /* configHEAP_ALLOCATION_TYPE */
+    }
+
+    return pxBlock;
+}
+/*-----------------------------------------------------------*/
+
+/** highest-fit */
+static BlockLink_t * prvHighestFit( size_t xWantedSize,
+                                    BlockLink_t ** ppxPreviousBlock ) /* PRIVILEGED_FUNCTION */
+{
+    BlockLink_t * pxPreviousBlock = &xStart;
+    BlockLink_t * pxBlock = heapPROTECT_BLOCK_POINTER( xStart.pxNextFreeBlock );
+    BlockLink_t * pxBlockTmp = NULL;
+    BlockLink_t * pxPreviousBlockTmp = NULL;
+
+    heapVALIDATE_BLOCK_POINTER( pxBlock );
+    heapPERF_VISIT();
+
+    /* Traverse the whole free block list for the block of adequate size with
+     * the highest address, which is the last one unless boundary tags keep
+     * the list out of address order. */
+    while( pxBlock->pxNextFreeBlock != heapPROTECT_BLOCK_POINTER( NULL ) )
+    {
+        if( ( pxBlock->xBlockSize >= xWantedSize ) &&
+            ( heapBLOCK_IN_PLACEMENT( pxBlock ) != pdFALSE ) &&
+            ( ( pxBlockTmp == NULL ) || ( pxBlock > pxBlockTmp ) ) )
+        {
+            pxPreviousBlockTmp = pxPreviousBlock;
+            pxBlockTmp = pxBlock;
+        }
+        else
+        {
+            mtCOVERAGE_TEST_MARKER();
+        }
+
+        pxPreviousBlock = pxBlock;
+        pxBlock = heapPROTECT_BLOCK_POINTER( pxBlock->pxNextFreeBlock );
+        heapVALIDATE_BLOCK_POINTER( pxBlock );
+        heapPERF_VISIT();
+    }
+
+    /* pxBlock is left on the end marker when no block fits. */
+    if( pxBlockTmp != NULL )
+    {
+        pxPreviousBlock = pxPreviousBlockTmp;
+        pxBlock = pxBlockTmp;
+    }
+    else
+    {
+        mtCOVERAGE_TEST_MARKER();
+    }
+
+    *ppxPreviousBlock = pxPreviousBlock;
+
+    return pxBlock;
+}
+/*-----------------------------------------------------------*/
+
+#if ( configHEAP_ALLOCATION_TYPE != 1 ) && ( configHEAP_ALLOCATION_TYPE != 2 ) && ( configHEAP_ALLOCATION_TYPE != 6 )
+
+/** first-fit */
+static BlockLink_t * prvFirstFit( size_t xWantedSize,
+                                  BlockLink_t ** ppxPreviousBlock ) /* PRIVILEGED_FUNCTION */
+{
+    BlockLink_t * pxPreviousBlock = &xStart;
+    BlockLink_t * pxBlock = heapPROTECT_BLOCK_POINTER( xStart.pxNextFreeBlock );
+
+    heapVALIDATE_BLOCK_POINTER( pxBlock );
+    heapPERF_VISIT();
+
+    /* Traverse the list from the start (lowest address) block until one of
+     * adequate size is found. */
+    while( ( ( pxBlock->xBlockSize < xWantedSize ) || ( heapBLOCK_IN_PLACEMENT( pxBlock ) == pdFALSE ) ) && ( pxBlock->pxNextFreeBlock != heapPROTECT_BLOCK_POINTER( NULL ) ) )
+    {
+        pxPreviousBlock = pxBlock;
+        pxBlock = heapPROTECT_BLOCK_POINTER( pxBlock->pxNextFreeBlock );
+        heapVALIDATE_BLOCK_POINTER( pxBlock );
+        heapPERF_VISIT();
+    }
+
+    *ppxPreviousBlock = pxPreviousBlock;
+
+    return pxBlock;
+}
+/*-----------------------------------------------------------*/
+
+#endif /* configHEAP_ALLOCATION_TYPE */
+
+#if ( configHEAP_ALLOCATION_TYPE == 1 ) || ( configHEAP_ALLOCATION_TYPE == 8 )
+
+/** best-fit */
+static BlockLink_t * prvBestFit( size_t xWantedSize,
+                                 BlockLink_t ** ppxPreviousBlock ) /* PRIVILEGED_FUNCTION */
+{
+    BlockLink_t * pxPreviousBlock = &xStart;
+    BlockLink_t * pxBlock = heapPROTECT_BLOCK_POINTER( xStart.pxNextFreeBlock );
+    BlockLink_t * pxBlockTmp = NULL;
+    BlockLink_t * pxPreviousBlockTmp = NULL;
+
+    heapVALIDATE_BLOCK_POINTER( pxBlock );
+    heapPERF_VISIT();
+
+    /* traverse the whole free block list */
+    while( pxBlock->pxNextFreeBlock != heapPROTECT_BLOCK_POINTER( NULL ) )
+    {
+        /* Check if the current block is a valid option and if another valid block
+           was found before and check wheter is a best fit */
+        if  (   ( pxBlock->xBlockSize >= xWantedSize )
+                &&
+                ( heapBLOCK_IN_PLACEMENT( pxBlock ) != pdFALSE )
+                &&
+                (   pxBlockTmp == NULL
+                    ||
+                    ( ( pxBlock->xBlockSize - xWantedSize ) < ( pxBlockTmp->xBlockSize - xWantedSize ) )
+                )
+            )
+        {
+            pxPreviousBlockTmp = pxPreviousBlock;
+            pxBlockTmp = pxBlock;
+        }
+        pxPreviousBlock = pxBlock;
+        pxBlock = heapPROTECT_BLOCK_POINTER( pxBlock->pxNextFreeBlock );
+        heapVALIDATE_BLOCK_POINTER( pxBlock );
+        heapPERF_VISIT();
+    }
+
+    /* pxBlock is left on the end marker when no block fits. */
+    if( pxBlockTmp != NULL )
+    {
+        pxPreviousBlock = pxPreviousBlockTmp;
+        pxBlock = pxBlockTmp;
+    }
+
+    *ppxPreviousBlock = pxPreviousBlock;
+
+    return pxBlock;
+}
+/*-----------------------------------------------------------*/
+
+#endif /* ( configHEAP_ALLOCATION_TYPE == 1 ) || ( configHEAP_ALLOCATION_TYPE == 8 ) */
+
+#if ( configHEAP_ALLOCATION_TYPE == 2 ) || ( configHEAP_ALLOCATION_TYPE == 8 )
+
+/** worst-fit */
+static BlockLink_t * prvWorstFit( size_t xWantedSize,
+                                  BlockLink_t ** ppxPreviousBlock ) /* PRIVILEGED_FUNCTION */
+{
+    BlockLink_t * pxPreviousBlock = &xStart;
+    BlockLink_t * pxBlock = heapPROTECT_BLOCK_POINTER( xStart.pxNextFreeBlock );
+    BlockLink_t * pxBlockTmp = NULL;
+    BlockLink_t * pxPreviousBlockTmp = NULL;
+
+    heapVALIDATE_BLOCK_POINTER( pxBlock );
+    heapPERF_VISIT();
+
+    /* traverse the whole free block list */
+    while( pxBlock->pxNextFreeBlock != heapPROTECT_BLOCK_POINTER( NULL ) )
+    {
+        /* Check if the current block is a valid option and if another valid block
+           was found before and check wheter is a worst fit */
+        if  (   ( pxBlock->xBlockSize >= xWantedSize )
+                &&
+                ( heapBLOCK_IN_PLACEMENT( pxBlock ) != pdFALSE )
+                &&
+                (   pxBlockTmp == NULL
+                    ||
+                    ( ( pxBlock->xBlockSize - xWantedSize ) > ( pxBlockTmp->xBlockSize - xWantedSize ) )
+                )
+            )
+        {
+            pxPreviousBlockTmp = pxPreviousBlock;
+            pxBlockTmp = pxBlock;
+        }
+        pxPreviousBlock = pxBlock;
+        pxBlock = heapPROTECT_BLOCK_POINTER( pxBlock->pxNextFreeBlock );
+        heapVALIDATE_BLOCK_POINTER( pxBlock );
+        heapPERF_VISIT();
+    }
+
+    /* pxBlock is left on the end marker when no block fits. */
+    if( pxBlockTmp != NULL )
+    {
+        pxPreviousBlock = pxPreviousBlockTmp;
+        pxBlock = pxBlockTmp;
+    }
+
+    *ppxPreviousBlock = pxPreviousBlock;
+
+    return pxBlock;
+}
+/*-----------------------------------------------------------*/
+
+#endif /* ( configHEAP_ALLOCATION_TYPE == 2 ) || ( configHEAP_ALLOCATION_TYPE == 8 ) */
+
+#if ( heapUSE_NEXT_FIT_ROVER == 1 )
+
+/** next-fit */
+static BlockLink_t * prvNextFit( size_t xWantedSize,
+                                 BlockLink_t ** ppxPreviousBlock ) /* PRIVILEGED_FUNCTION */
+{
+    BlockLink_t * pxPreviousBlock;
+    BlockLink_t * pxBlock;
+
+    /* Start after the rover instead of at xStart, and wrap around at the end
+     * marker until every block has been looked at once. */
+    pxPreviousBlock = pxNextFitRover;
+    pxBlock = heapPROTECT_BLOCK_POINTER( pxPreviousBlock->pxNextFreeBlock );
+    heapVALIDATE_BLOCK_POINTER( pxBlock );
+    heapPERF_VISIT();
+
+    while( ( pxBlock == pxEnd ) || ( pxBlock->xBlockSize < xWantedSize ) || ( heapBLOCK_IN_PLACEMENT( pxBlock ) == pdFALSE ) )
+    {
+        if( pxBlock == pxEnd )
+        {
+            pxPreviousBlock = &xStart;
+        }
+        else
+        {
+            pxPreviousBlock = pxBlock;
+        }
+
+        if( pxPreviousBlock == pxNextFitRover )
+        {
+            /* Back where the search started, so no block is large enough. */
+            pxBlock = pxEnd;
+            break;
+        }
+        else
+        {
+            mtCOVERAGE_TEST_MARKER();
+        }
+
+        pxBlock = heapPROTECT_BLOCK_POINTER( pxPreviousBlock->pxNextFreeBlock );
+        heapVALIDATE_BLOCK_POINTER( pxBlock );
+        heapPERF_VISIT();
+    }
+
+    *ppxPreviousBlock = pxPreviousBlock;
+
+    return pxBlock;
+}
+/*-----------------------------------------------------------*/
+
+#endif /* heapUSE_NEXT_FIT_ROVER */
+
+#if ( configHEAP_ALLOCATION_TYPE == 8 )
+
+BaseType_t xPortSetAllocationPolicy( eHeapAllocationPolicy ePolicy )
+{
+    BaseType_t xReturn = pdFAIL;
+
+    if( ( ePolicy == eHeapPolicyFirstFit ) || ( ePolicy == eHeapPolicyBestFit ) ||
+        ( ePolicy == eHeapPolicyWorstFit ) || ( ePolicy == eHeapPolicyNextFit ) )
+    {
+        vTaskSuspendAll();
+        {
+            eAllocationPolicy = ePolicy;
+
+            /* All the policies share the xStart list, so the policy can be
+             * changed at any time.  Next-fit starts again from the lowest
+             * address. */
+            pxNextFitRover = &xStart;
+        }
+        ( void ) xTaskResumeAll();
+
+        xReturn = pdPASS;
+    }
+    else
+    {
+        mtCOVERAGE_TEST_MARKER();
+    }
+
+    return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+eHeapAllocationPolicy ePortGetAllocationPolicy( void )
+{
+    return eAllocationPolicy;
+}
+/*-----------------------------------------------------------*/
+
+#endif /* configHEAP_ALLOCATION_TYPE == 8 */
+
+#endif /* heapUSE_INDEXED_FREE_BLOCKS */
+
+#if ( heapUSE_BOUNDARY_TAGS == 1 )
+
+static void prvInsertBlockIntoFreeList( BlockLink_t * pxBlockToInsert ) /* PRIVILEGED_FUNCTION */
+{
+    BlockLink_t * pxNeighbour;
+    size_t xPreviousBlockSize;
+
+    /* The footer just in front of the block being inserted belongs to the block
+     * physically before it.  If that block is free the two are merged. */
+    xPreviousBlockSize = heapPREVIOUS_FOOTER( pxBlockToInsert );
+
+    if( heapBLOCK_SIZE_IS_VALID( xPreviousBlockSize ) != 0 )
+    {
+        pxNeighbour = ( void * ) ( ( ( uint8_t * ) pxBlockToInsert ) - xPreviousBlockSize );
+        heapVALIDATE_BLOCK_POINTER( pxNeighbour );
+
+        prvUnlinkFreeBlock( pxNeighbour );
+        pxNeighbour->xBlockSize += pxBlockToInsert->xBlockSize;
+        heapZERO_JOINED_HEADER( pxBlockToInsert );
+        pxBlockToInsert = pxNeighbour;
+    }
+    else
+    {
+        mtCOVERAGE_TEST_MARKER();
+    }
+
+    /* The end marker is flagged as allocated, so the block physically after
+     * the block being inserted can always be inspected. */
+    pxNeighbour = ( void * ) ( ( ( uint8_t * ) pxBlockToInsert ) + pxBlockToInsert->xBlockSize );
+    heapVALIDATE_BLOCK_POINTER( pxNeighbour );
+
+    if( heapBLOCK_IS_ALLOCATED( pxNeighbour ) == 0 )
+    {
+        prvUnlinkFreeBlock( pxNeighbour );
+        pxBlockToInsert->xBlockSize += pxNeighbour->xBlockSize;
+        heapZERO_JOINED_HEADER( pxNeighbour );
+    }
+    else
+    {
+        mtCOVERAGE_TEST_MARKER();
+    }
+
+    heapWRITE_FOOTER( pxBlockToInsert );
+    prvLinkFreeBlock( pxBlockToInsert );
+}
+
+#elif ( configHEAP_ALLOCATION_TYPE == 7 )
+
+static void prvInsertBlockIntoFreeList( BlockLink_t * pxBlockToInsert ) /* PRIVILEGED_FUNCTION */
+{
+    size_t xOffset, xBuddyOffset, xBlockSize;
+    BlockLink_t * pxBuddy;
+
+    xOffset = ( size_t ) ( ( ( uint8_t * ) pxBlockToInsert ) - pucBuddyHeapStart );
+    xBlockSize = pxBlockToInsert->xBlockSize;
+    xBuddyOffset = xOffset ^ xBlockSize;
+
+    /* The buddy of a block always starts with a header.  It can only be merged
+     * if it is inside the heap, free and not split, that is if its header holds
+     * the same size as the block with the allocation bit clear.  At most one
+     * iteration per block size. */
+    while( ( xBlockSize < heapBUDDY_MAX_BLOCK_SIZE ) &&
+           ( ( xBuddyOffset + xBlockSize ) <= xBuddyHeapSize ) &&
+           ( heapBUDDY_BLOCK_AT( xBuddyOffset )->xBlockSize == xBlockSize ) )
+    {
+        pxBuddy = heapBUDDY_BLOCK_AT( xBuddyOffset );
+        heapVALIDATE_BLOCK_POINTER( pxBuddy );
+        prvUnlinkFreeBlock( pxBuddy );
+        heapZERO_JOINED_HEADER( heapBUDDY_BLOCK_AT( xOffset | xBuddyOffset ) );
+
+        /* The merged block starts at the lower of the two. */
+        xOffset &= xBuddyOffset;
+        xBlockSize <<= 1;
+        xBuddyOffset = xOffset ^ xBlockSize;
+    }
+
+    pxBlockToInsert = heapBUDDY_BLOCK_AT( xOffset );
+    pxBlockToInsert->xBlockSize = xBlockSize;
+    prvLinkFreeBlock( pxBlockToInsert );
+}
+
+#else /* heapUSE_BOUNDARY_TAGS */
+
+static void prvInsertBlockIntoFreeList( BlockLink_t * pxBlockToInsert ) /* PRIVILEGED_FUNCTION */
+{
+    BlockLink_t * pxIterator;
+    uint8_t * puc;
+
+    /* Iterate through the list until a block is found that has a higher address
+     * than the block being inserted. */
+    for( pxIterator = &xStart; heapPROTECT_BLOCK_POINTER( pxIterator->pxNextFreeBlock ) < pxBlockToInsert; pxIterator = heapPROTECT_BLOCK_POINTER( pxIterator->pxNextFreeBlock ) )
+    {
+        /* Nothing to do here, just iterate to the right position. */
+    }
+
+    if( pxIterator != &xStart )
+    {
+        heapVALIDATE_BLOCK_POINTER( pxIterator );
+    }
+
+    /* Do the block being inserted, and the block it is being inserted after
+     * make a contiguous block of memory? */
+    puc = ( uint8_t * ) pxIterator;
+
+    if( ( puc + pxIterator->xBlockSize ) == ( uint8_t * ) pxBlockToInsert )
+    {
+        heapSTATS_REMOVE_FREE_BLOCK( pxIterator->xBlockSize );
+        pxIterator->xBlockSize += pxBlockToInsert->xBlockSize;
+        heapZERO_JOINED_HEADER( pxBlockToInsert );
+        pxBlockToInsert = pxIterator;
+    }
+    else
+    {
+        mtCOVERAGE_TEST_MARKER();
+    }
+
+    /* Do the block being inserted, and the block it is being inserted before
+     * make a contiguous block of memory? */
+    puc = ( ( uint8_t * ) pxBlockToInsert ) + pxBlockToInsert->xBlockSize;
+
+    if( puc == ( uint8_t * ) heapPROTECT_BLOCK_POINTER( pxIterator->pxNextFreeBlock ) )
+    {
+        /* The end marker of the heap, or of a heap region, has a size of 0 and
+         * is never merged. */
+        if( heapPROTECT_BLOCK_POINTER( pxIterator->pxNextFreeBlock )->xBlockSize != 0U )
+        {
+            /* Form one big block from the two blocks. */
+            heapSTATS_REMOVE_FREE_BLOCK( heapPROTECT_BLOCK_POINTER( pxIterator->pxNextFreeBlock )->xBlockSize );
+
+            #if ( heapUSE_NEXT_FIT_ROVER == 1 )
+            {
+                /* The rover must not be left on the block that is absorbed. */
+                if( pxNextFitRover == heapPROTECT_BLOCK_POINTER( pxIterator->pxNextFreeBlock ) )
+                {
+                    pxNextFitRover = pxBlockToInsert;
+                }
+                else
+                {
+                    mtCOVERAGE_TEST_MARKER();
+                }
+            }
+            #endif
+
+            pxBlockToInsert->xBlockSize += heapPROTECT_BLOCK_POINTER( pxIterator->pxNextFreeBlock )->xBlockSize;
+            pxBlockToInsert->pxNextFreeBlock = heapPROTECT_BLOCK_POINTER( pxIterator->pxNextFreeBlock )->pxNextFreeBlock;
+
+            /* puc still points at the block that was absorbed. */
+            heapZERO_JOINED_HEADER( ( BlockLink_t * ) ( void * ) puc );
+        }
+        else
+        {
+            pxBlockToInsert->pxNextFreeBlock = pxIterator->pxNextFreeBlock;
+        }
+    }
+    else
+    {
+        pxBlockToInsert->pxNextFreeBlock = pxIterator->pxNextFreeBlock;
+    }
+
+    heapSTATS_ADD_FREE_BLOCK( pxBlockToInsert->xBlockSize );
+
+    /* If the block being inserted plugged a gab, so was merged with the block
+     * before and the block after, then it's pxNextFreeBlock pointer will have
+     * already been set, and should not be set here as that would make it point
+     * to itself. */
+    if( pxIterator != pxBlockToInsert )
+    {
+        pxIterator->pxNextFreeBlock = heapPROTECT_BLOCK_POINTER( pxBlockToInsert );
+    }
+    else
+    {
+        mtCOVERAGE_TEST_MARKER();
+    }
+}
+
+#endif /* heapUSE_BOUNDARY_TAGS */
+/*-----------------------------------------------------------*/
+
+#if ( configHEAP_ALLOCATION_TYPE == 4 )
+
+static void prvTLSFMapping( size_t xSize,
+                            UBaseType_t * puxFirstLevel,
+                            UBaseType_t * puxSecondLevel ) /* PRIVILEGED_FUNCTION */
+{
+    UBaseType_t uxMostSignificantBit;
+
+    if( xSize < heapTLSF_SMALL_BLOCK_SIZE )
+    {
+        /* Small blocks are stored in linear classes of portBYTE_ALIGNMENT
+         * bytes. */
+        *puxFirstLevel = 0;
+        *puxSecondLevel = ( UBaseType_t ) ( xSize / portBYTE_ALIGNMENT );
+    }
+    else
+    {
+        /* The first level is the power of two the size falls in, the second
+         * level is given by the next heapTLSF_SL_INDEX_COUNT_LOG2 bits. */
+        uxMostSignificantBit = ( UBaseType_t ) heapFLS( xSize );
+        *puxSecondLevel = ( UBaseType_t ) ( ( xSize >> ( uxMostSignificantBit - heapTLSF_SL_INDEX_COUNT_LOG2 ) ) ^ heapTLSF_SL_INDEX_COUNT );
+        *puxFirstLevel = uxMostSignificantBit - ( heapTLSF_FL_INDEX_SHIFT - 1U );
+    }
+}
+/*-----------------------------------------------------------*/
 
-                    /* The block is being returned - it is allocated and owned
-                     * by the application and has no "next" block. */
-                    heapALLOCATE_BLOCK( pxBlock );
-                    pxBlock->pxNextFreeBlock = NULL;
-                    xNumberOfSuccessfulAllocations++;
-                }
-                else
-                {
-                    mtCOVERAGE_TEST_MARKER();
-                }
+static UBaseType_t prvFreeListIndex( size_t xSize ) /* PRIVILEGED_FUNCTION */
+{
+    UBaseType_t uxFirstLevel, uxSecondLevel;
+
+    prvTLSFMapping( xSize, &uxFirstLevel, &uxSecondLevel );
+
+    return ( uxFirstLevel * heapTLSF_SL_INDEX_COUNT ) + uxSecondLevel;
+}
+/*-----------------------------------------------------------*/
+
+static BlockLink_t * prvFindFreeBlock( size_t xWantedSize ) /* PRIVILEGED_FUNCTION */
+{
+    UBaseType_t uxFirstLevel, uxSecondLevel;
+    uint32_t ulBitmap;
+    BlockLink_t * pxBlock = NULL;
+
+    /* Round the request up to the next second level class, so every block in
+     * the list it maps to is large enough and only the head needs to be
+     * looked at. */
+    if( xWantedSize >= heapTLSF_SMALL_BLOCK_SIZE )
+    {
+        xWantedSize += ( ( ( size_t ) 1 ) << ( heapFLS( xWantedSize ) - heapTLSF_SL_INDEX_COUNT_LOG2 ) ) - 1U;
+    }
+
+    prvTLSFMapping( xWantedSize, &uxFirstLevel, &uxSecondLevel );
+
+    if( uxFirstLevel < heapTLSF_FL_INDEX_COUNT )
+    {
+        /* Look for a non empty list in the same first level... */
+        ulBitmap = ulTLSFSecondLevelBitmap[ uxFirstLevel ] & ( ~( ( uint32_t ) 0U ) << uxSecondLevel );
+
+        if( ulBitmap == 0U )
+        {
+            /* ...else take the smallest non empty list of a larger first
+             * level. */
+            ulBitmap = ulTLSFFirstLevelBitmap & ( ~( ( uint32_t ) 0U ) << ( uxFirstLevel + 1U ) );
+
+            if( ulBitmap != 0U )
+            {
+                uxFirstLevel = ( UBaseType_t ) heapFFS( ulBitmap );
+                ulBitmap = ulTLSFSecondLevelBitmap[ uxFirstLevel ];
             }
             else
             {
@@ -387,276 +4338,756 @@ void * pvPortMalloc( size_t xWantedSize )
             mtCOVERAGE_TEST_MARKER();
         }
 
-        traceMALLOC( pvReturn, xWantedSize );
+        if( ulBitmap != 0U )
+        {
+            uxSecondLevel = ( UBaseType_t ) heapFFS( ulBitmap );
+            pxBlock = pxFreeLists[ ( uxFirstLevel * heapTLSF_SL_INDEX_COUNT ) + uxSecondLevel ];
+            heapVALIDATE_BLOCK_POINTER( pxBlock );
+            heapPERF_VISIT();
+        }
+        else
+        {
+            mtCOVERAGE_TEST_MARKER();
+        }
+    }
+    else
+    {
+        mtCOVERAGE_TEST_MARKER();
     }
-    ( void ) xTaskResumeAll();
 
-    #if ( configUSE_MALLOC_FAILED_HOOK == 1 )
+    return pxBlock;
+}
+
+#endif /* configHEAP_ALLOCATION_TYPE == 4 */
+/*-----------------------------------------------------------*/
+
+#if ( configHEAP_ALLOCATION_TYPE == 5 )
+
+static UBaseType_t prvFreeListIndex( size_t xSize ) /* PRIVILEGED_FUNCTION */
+{
+    UBaseType_t uxIndex = 0;
+    size_t xClassLimit = heapSEGREGATED_SMALLEST_CLASS_SIZE << 1;
+
+    /* At most heapSEGREGATED_SMALL_CLASS_COUNT iterations. */
+    while( ( uxIndex < heapSEGREGATED_LARGE_LIST ) && ( xSize >= xClassLimit ) )
     {
-        if( pvReturn == NULL )
+        uxIndex++;
+        xClassLimit <<= 1;
+    }
+
+    return uxIndex;
+}
+/*-----------------------------------------------------------*/
+
+static BlockLink_t * prvFindFreeBlock( size_t xWantedSize ) /* PRIVILEGED_FUNCTION */
+{
+    UBaseType_t uxClass, uxIndex;
+    BlockLink_t * pxBlock;
+
+    uxClass = prvFreeListIndex( xWantedSize );
+    pxBlock = pxFreeLists[ uxClass ];
+    heapPERF_VISIT();
+
+    /* Kernel objects are allocated and freed with a handful of sizes, so a
+     * block of the wanted size is normally found on the head of its own list
+     * where the last vPortFree() pushed it. */
+    if( ( pxBlock == NULL ) || ( pxBlock->xBlockSize < xWantedSize ) )
+    {
+        pxBlock = NULL;
+
+        /* Every block of a larger small class is large enough, so the head of
+         * the first non empty one can be popped. */
+        for( uxIndex = uxClass + 1U; ( uxIndex < heapSEGREGATED_LARGE_LIST ) && ( pxBlock == NULL ); uxIndex++ )
         {
-            vApplicationMallocFailedHook();
+            pxBlock = pxFreeLists[ uxIndex ];
+            heapPERF_VISIT();
+        }
+
+        /* Otherwise fall back to a first fit walk of the large list, then of
+         * the rest of the wanted size's own list. */
+        if( ( pxBlock == NULL ) && ( uxClass != heapSEGREGATED_LARGE_LIST ) )
+        {
+            pxBlock = pxFreeLists[ heapSEGREGATED_LARGE_LIST ];
+            heapPERF_VISIT();
+
+            while( ( pxBlock != NULL ) && ( pxBlock->xBlockSize < xWantedSize ) )
+            {
+                pxBlock = heapPROTECT_BLOCK_POINTER( pxBlock->pxNextFreeBlock );
+                heapPERF_VISIT();
+            }
+        }
+        else
+        {
+            mtCOVERAGE_TEST_MARKER();
+        }
+
+        if( ( pxBlock == NULL ) && ( pxFreeLists[ uxClass ] != NULL ) )
+        {
+            pxBlock = heapPROTECT_BLOCK_POINTER( pxFreeLists[ uxClass ]->pxNextFreeBlock );
+            heapPERF_VISIT();
+
+            while( ( pxBlock != NULL ) && ( pxBlock->xBlockSize < xWantedSize ) )
+            {
+                pxBlock = heapPROTECT_BLOCK_POINTER( pxBlock->pxNextFreeBlock );
+                heapPERF_VISIT();
+            }
         }
         else
         {
             mtCOVERAGE_TEST_MARKER();
         }
     }
-    #endif /* if ( configUSE_MALLOC_FAILED_HOOK == 1 ) */
+    else
+    {
+        mtCOVERAGE_TEST_MARKER();
+    }
 
-    configASSERT( ( ( ( size_t ) pvReturn ) & ( size_t ) portBYTE_ALIGNMENT_MASK ) == 0 );
-    return pvReturn;
+    if( pxBlock != NULL )
+    {
+        heapVALIDATE_BLOCK_POINTER( pxBlock );
+    }
+
+    return pxBlock;
 }
 
+#endif /* configHEAP_ALLOCATION_TYPE == 5 */
+/*-----------------------------------------------------------*/
+
+#if ( configHEAP_ALLOCATION_TYPE == 7 )
 
+static UBaseType_t prvFreeListIndex( size_t xSize ) /* PRIVILEGED_FUNCTION */
+{
+    /* Block sizes are powers of two. */
+    return ( UBaseType_t ) heapFLS( xSize );
+}
 /*-----------------------------------------------------------*/
 
-void vPortFree( void * pv )
+static BlockLink_t * prvFindFreeBlock( size_t xWantedSize ) /* PRIVILEGED_FUNCTION */
 {
-    uint8_t * puc = ( uint8_t * ) pv;
-    BlockLink_t * pxLink;
+    UBaseType_t uxIndex;
+    BlockLink_t * pxBlock = NULL;
 
-    if( pv != NULL )
+    /* Take the first block of the smallest size that is not smaller than the
+     * wanted size.  At most heapFREE_LIST_COUNT iterations. */
+    for( uxIndex = prvFreeListIndex( xWantedSize ); ( uxIndex < heapFREE_LIST_COUNT ) && ( pxBlock == NULL ); uxIndex++ )
     {
-        /* The memory being freed will have an BlockLink_t structure immediately
-         * before it. */
-        puc -= xHeapStructSize;
+        pxBlock = pxFreeLists[ uxIndex ];
+        heapPERF_VISIT();
+    }
 
-        /* This casting is to keep the compiler from issuing warnings. */
-        pxLink = ( void * ) puc;
+    if( pxBlock != NULL )
+    {
+        heapVALIDATE_BLOCK_POINTER( pxBlock );
+    }
 
-        heapVALIDATE_BLOCK_POINTER( pxLink );
-        configASSERT( heapBLOCK_IS_ALLOCATED( pxLink ) != 0 );
-        configASSERT( pxLink->pxNextFreeBlock == NULL );
+    return pxBlock;
+}
 
-        if( heapBLOCK_IS_ALLOCATED( pxLink ) != 0 )
+#endif /* configHEAP_ALLOCATION_TYPE == 7 */
+/*-----------------------------------------------------------*/
+
+#if ( heapUSE_SEGREGATED_LISTS == 1 )
+
+static void prvLinkFreeBlock( BlockLink_t * pxBlock ) /* PRIVILEGED_FUNCTION */
+{
+    UBaseType_t uxIndex;
+    BlockLink_t * pxHead;
+
+    uxIndex = prvFreeListIndex( pxBlock->xBlockSize );
+    configASSERT( uxIndex < heapFREE_LIST_COUNT );
+
+    /* Push the block on the head of its list. */
+    pxHead = pxFreeLists[ uxIndex ];
+    pxBlock->pxNextFreeBlock = heapPROTECT_BLOCK_POINTER( pxHead );
+    heapPREV_FREE_BLOCK( pxBlock ) = heapPROTECT_BLOCK_POINTER( NULL );
+
+    if( pxHead != NULL )
+    {
+        heapPREV_FREE_BLOCK( pxHead ) = heapPROTECT_BLOCK_POINTER( pxBlock );
+    }
+    else
+    {
+        mtCOVERAGE_TEST_MARKER();
+    }
+
+    pxFreeLists[ uxIndex ] = pxBlock;
+    heapSTATS_ADD_FREE_BLOCK( pxBlock->xBlockSize );
+
+    #if ( configHEAP_ALLOCATION_TYPE == 4 )
+    {
+        ulTLSFFirstLevelBitmap |= ( ( uint32_t ) 1U ) << ( uxIndex / heapTLSF_SL_INDEX_COUNT );
+        ulTLSFSecondLevelBitmap[ uxIndex / heapTLSF_SL_INDEX_COUNT ] |= ( ( uint32_t ) 1U ) << ( uxIndex % heapTLSF_SL_INDEX_COUNT );
+    }
+    #endif
+}
+/*-----------------------------------------------------------*/
+
+static void prvUnlinkFreeBlock( BlockLink_t * pxBlock ) /* PRIVILEGED_FUNCTION */
+{
+    UBaseType_t uxIndex;
+    BlockLink_t * pxNext = heapPROTECT_BLOCK_POINTER( pxBlock->pxNextFreeBlock );
+    BlockLink_t * pxPrevious = heapPROTECT_BLOCK_POINTER( heapPREV_FREE_BLOCK( pxBlock ) );
+
+    heapSTATS_REMOVE_FREE_BLOCK( pxBlock->xBlockSize );
+
+    if( pxNext != NULL )
+    {
+        heapVALIDATE_BLOCK_POINTER( pxNext );
+        heapPREV_FREE_BLOCK( pxNext ) = heapPROTECT_BLOCK_POINTER( pxPrevious );
+    }
+    else
+    {
+        mtCOVERAGE_TEST_MARKER();
+    }
+
+    if( pxPrevious != NULL )
+    {
+        heapVALIDATE_BLOCK_POINTER( pxPrevious );
+        pxPrevious->pxNextFreeBlock = heapPROTECT_BLOCK_POINTER( pxNext );
+    }
+    else
+    {
+        /* The block was the head of its list. */
+        uxIndex = prvFreeListIndex( pxBlock->xBlockSize );
+        pxFreeLists[ uxIndex ] = pxNext;
+
+        #if ( configHEAP_ALLOCATION_TYPE == 4 )
         {
-            if( pxLink->pxNextFreeBlock == NULL )
+            if( pxNext == NULL )
             {
-                /* The block is being returned to the heap - it is no longer
-                 * allocated. */
-                heapFREE_BLOCK( pxLink );
-                #if ( configHEAP_CLEAR_MEMORY_ON_FREE == 1 )
+                ulTLSFSecondLevelBitmap[ uxIndex / heapTLSF_SL_INDEX_COUNT ] &= ~( ( ( uint32_t ) 1U ) << ( uxIndex % heapTLSF_SL_INDEX_COUNT ) );
+
+                if( ulTLSFSecondLevelBitmap[ uxIndex / heapTLSF_SL_INDEX_COUNT ] == 0U )
                 {
-                    /* Check for underflow as this can occur if xBlockSize is
-                     * overwritten in a heap block. */
-                    if( heapSUBTRACT_WILL_UNDERFLOW( pxLink->xBlockSize, xHeapStructSize ) == 0 )
-                    {
-                        ( void ) memset( puc + xHeapStructSize, 0, pxLink->xBlockSize - xHeapStructSize );
-                    }
+                    ulTLSFFirstLevelBitmap &= ~( ( ( uint32_t ) 1U ) << ( uxIndex / heapTLSF_SL_INDEX_COUNT ) );
                 }
-                #endif
-
-                vTaskSuspendAll();
+                else
                 {
-                    /* Add this block to the list of free blocks. */
-                    xFreeBytesRemaining += pxLink->xBlockSize;
-                    traceFREE( pv, pxLink->xBlockSize );
-                    prvInsertBlockIntoFreeList( ( ( BlockLink_t * ) pxLink ) );
-                    xNumberOfSuccessfulFrees++;
+                    mtCOVERAGE_TEST_MARKER();
                 }
-                ( void ) xTaskResumeAll();
             }
             else
             {
                 mtCOVERAGE_TEST_MARKER();
             }
         }
+        #endif /* configHEAP_ALLOCATION_TYPE == 4 */
+    }
+}
+
+#endif /* heapUSE_SEGREGATED_LISTS */
+/*-----------------------------------------------------------*/
+
+#if ( heapUSE_BOUNDARY_TAGS == 1 ) && ( heapUSE_INDEXED_FREE_BLOCKS == 0 )
+
+static void prvLinkFreeBlock( BlockLink_t * pxBlock ) /* PRIVILEGED_FUNCTION */
+{
+    BlockLink_t * pxFirstBlock = heapPROTECT_BLOCK_POINTER( xStart.pxNextFreeBlock );
+
+    /* Push the block on the head of the list.  pxEnd has no room for a back
+     * link, so it never gets one. */
+    pxBlock->pxNextFreeBlock = xStart.pxNextFreeBlock;
+    heapPREV_FREE_BLOCK( pxBlock ) = heapPROTECT_BLOCK_POINTER( &xStart );
+
+    if( pxFirstBlock != pxEnd )
+    {
+        heapPREV_FREE_BLOCK( pxFirstBlock ) = heapPROTECT_BLOCK_POINTER( pxBlock );
+    }
+    else
+    {
+        mtCOVERAGE_TEST_MARKER();
+    }
+
+    xStart.pxNextFreeBlock = heapPROTECT_BLOCK_POINTER( pxBlock );
+    heapSTATS_ADD_FREE_BLOCK( pxBlock->xBlockSize );
+}
+/*-----------------------------------------------------------*/
+
+static void prvUnlinkFreeBlock( BlockLink_t * pxBlock ) /* PRIVILEGED_FUNCTION */
+{
+    BlockLink_t * pxNext = heapPROTECT_BLOCK_POINTER( pxBlock->pxNextFreeBlock );
+    BlockLink_t * pxPrevious = heapPROTECT_BLOCK_POINTER( heapPREV_FREE_BLOCK( pxBlock ) );
+
+    heapSTATS_REMOVE_FREE_BLOCK( pxBlock->xBlockSize );
+
+    #if ( heapUSE_NEXT_FIT_ROVER == 1 )
+    {
+        /* Blocks are unlinked when they are allocated and when they are merged
+         * with a neighbour, so the rover steps back to a block that stays in
+         * the list. */
+        if( pxNextFitRover == pxBlock )
+        {
+            pxNextFitRover = pxPrevious;
+        }
+        else
+        {
+            mtCOVERAGE_TEST_MARKER();
+        }
+    }
+    #endif
+
+    if( pxPrevious != &xStart )
+    {
+        heapVALIDATE_BLOCK_POINTER( pxPrevious );
+    }
+
+    pxPrevious->pxNextFreeBlock = pxBlock->pxNextFreeBlock;
+
+    if( pxNext != pxEnd )
+    {
+        heapVALIDATE_BLOCK_POINTER( pxNext );
+        heapPREV_FREE_BLOCK( pxNext ) = heapPROTECT_BLOCK_POINTER( pxPrevious );
+    }
+    else
+    {
+        mtCOVERAGE_TEST_MARKER();
+    }
+}
+
+#endif /* ( heapUSE_BOUNDARY_TAGS == 1 ) && ( heapUSE_INDEXED_FREE_BLOCKS == 0 ) */
+/*-----------------------------------------------------------*/
+
+#if ( heapUSE_BEST_FIT_TREE == 1 )
+
+static size_t prvTreeHeight( BlockLink_t * pxNode ) /* PRIVILEGED_FUNCTION */
+{
+    size_t xHeight = 0;
+
+    if( pxNode != NULL )
+    {
+        xHeight = heapTREE_HEIGHT( pxNode );
+    }
+    else
+    {
+        mtCOVERAGE_TEST_MARKER();
+    }
+
+    return xHeight;
+}
+/*-----------------------------------------------------------*/
+
+static void prvTreeUpdateHeight( BlockLink_t * pxNode ) /* PRIVILEGED_FUNCTION */
+{
+    size_t xLeftHeight = prvTreeHeight( heapTREE_LEFT( pxNode ) );
+    size_t xRightHeight = prvTreeHeight( heapTREE_RIGHT( pxNode ) );
+
+    heapTREE_HEIGHT( pxNode ) = ( ( xLeftHeight > xRightHeight ) ? xLeftHeight : xRightHeight ) + 1U;
+}
+/*-----------------------------------------------------------*/
+
+static BlockLink_t * prvTreeRotateLeft( BlockLink_t * pxNode ) /* PRIVILEGED_FUNCTION */
+{
+    BlockLink_t * pxPivot = heapTREE_RIGHT( pxNode );
+
+    heapTREE_SET_RIGHT( pxNode, heapTREE_LEFT( pxPivot ) );
+    heapTREE_SET_LEFT( pxPivot, pxNode );
+    prvTreeUpdateHeight( pxNode );
+    prvTreeUpdateHeight( pxPivot );
+
+    return pxPivot;
+}
+/*-----------------------------------------------------------*/
+
+static BlockLink_t * prvTreeRotateRight( BlockLink_t * pxNode ) /* PRIVILEGED_FUNCTION */
+{
+    BlockLink_t * pxPivot = heapTREE_LEFT( pxNode );
+
+    heapTREE_SET_LEFT( pxNode, heapTREE_RIGHT( pxPivot ) );
+    heapTREE_SET_RIGHT( pxPivot, pxNode );
+    prvTreeUpdateHeight( pxNode );
+    prvTreeUpdateHeight( pxPivot );
+
+    return pxPivot;
+}
+/*-----------------------------------------------------------*/
+
+static BlockLink_t * prvTreeBalance( BlockLink_t * pxNode ) /* PRIVILEGED_FUNCTION */
+{
+    BlockLink_t * pxChild;
+    size_t xLeftHeight = prvTreeHeight( heapTREE_LEFT( pxNode ) );
+    size_t xRightHeight = prvTreeHeight( heapTREE_RIGHT( pxNode ) );
+
+    if( xLeftHeight > ( xRightHeight + 1U ) )
+    {
+        /* Left heavy.  A left child that leans right is rotated first. */
+        pxChild = heapTREE_LEFT( pxNode );
+
+        if( prvTreeHeight( heapTREE_LEFT( pxChild ) ) < prvTreeHeight( heapTREE_RIGHT( pxChild ) ) )
+        {
+            heapTREE_SET_LEFT( pxNode, prvTreeRotateLeft( pxChild ) );
+        }
+        else
+        {
+            mtCOVERAGE_TEST_MARKER();
+        }
+
+        pxNode = prvTreeRotateRight( pxNode );
+    }
+    else if( xRightHeight > ( xLeftHeight + 1U ) )
+    {
+        /* Right heavy.  A right child that leans left is rotated first. */
+        pxChild = heapTREE_RIGHT( pxNode );
+
+        if( prvTreeHeight( heapTREE_RIGHT( pxChild ) ) < prvTreeHeight( heapTREE_LEFT( pxChild ) ) )
+        {
+            heapTREE_SET_RIGHT( pxNode, prvTreeRotateRight( pxChild ) );
+        }
         else
         {
             mtCOVERAGE_TEST_MARKER();
         }
+
+        pxNode = prvTreeRotateLeft( pxNode );
+    }
+    else
+    {
+        prvTreeUpdateHeight( pxNode );
     }
-}
-/*-----------------------------------------------------------*/
 
-size_t xPortGetFreeHeapSize( void )
-{
-    return xFreeBytesRemaining;
+    return pxNode;
 }
 /*-----------------------------------------------------------*/
 
-size_t xPortGetMinimumEverFreeHeapSize( void )
+static BlockLink_t ** prvTreeChildSlot( BlockLink_t * pxNode,
+                                        BlockLink_t * pxBlock ) /* PRIVILEGED_FUNCTION */
 {
-    return xMinimumEverFreeBytesRemaining;
-}
-/*-----------------------------------------------------------*/
+    BlockLink_t ** ppxSlot;
 
-void vPortInitialiseBlocks( void )
-{
-    /* This just exists to keep the linker quiet. */
+    /* Blocks are ordered by size, then by address, so every key is unique. */
+    if( ( pxBlock->xBlockSize < pxNode->xBlockSize ) ||
+        ( ( pxBlock->xBlockSize == pxNode->xBlockSize ) && ( pxBlock < pxNode ) ) )
+    {
+        ppxSlot = heapTREE_LEFT_SLOT( pxNode );
+    }
+    else
+    {
+        ppxSlot = heapTREE_RIGHT_SLOT( pxNode );
+    }
+
+    return ppxSlot;
 }
 /*-----------------------------------------------------------*/
 
-void * pvPortCalloc( size_t xNum,
-                     size_t xSize )
+static void prvLinkFreeBlock( BlockLink_t * pxBlock ) /* PRIVILEGED_FUNCTION */
 {
-    void * pv = NULL;
+    BlockLink_t ** ppxPath[ heapTREE_MAX_HEIGHT ];
+    BlockLink_t ** ppxSlot = &pxTreeRoot;
+    BlockLink_t * pxNode;
+    UBaseType_t uxDepth = 0;
 
-    if( heapMULTIPLY_WILL_OVERFLOW( xNum, xSize ) == 0 )
+    /* Walk down to the empty slot the block belongs in, remembering the path
+     * so it can be rebalanced on the way back up. */
+    for( pxNode = heapTREE_LOAD( ppxSlot ); pxNode != NULL; pxNode = heapTREE_LOAD( ppxSlot ) )
     {
-        pv = pvPortMalloc( xNum * xSize );
+        heapVALIDATE_BLOCK_POINTER( pxNode );
+        configASSERT( uxDepth < heapTREE_MAX_HEIGHT );
+        ppxPath[ uxDepth ] = ppxSlot;
+        uxDepth++;
+        ppxSlot = prvTreeChildSlot( pxNode, pxBlock );
+    }
 
-        if( pv != NULL )
-        {
-            ( void ) memset( pv, 0, xNum * xSize );
-        }
+    heapTREE_SET_LEFT( pxBlock, NULL );
+    heapTREE_SET_RIGHT( pxBlock, NULL );
+    heapTREE_HEIGHT( pxBlock ) = 1U;
+    heapTREE_STORE( ppxSlot, pxBlock );
+
+    while( uxDepth > 0U )
+    {
+        uxDepth--;
+        heapTREE_STORE( ppxPath[ uxDepth ], prvTreeBalance( heapTREE_LOAD( ppxPath[ uxDepth ] ) ) );
     }
 
-    return pv;
+    heapSTATS_ADD_FREE_BLOCK( pxBlock->xBlockSize );
 }
 /*-----------------------------------------------------------*/
 
-static void prvHeapInit( void ) /* PRIVILEGED_FUNCTION */
+static void prvUnlinkFreeBlock( BlockLink_t * pxBlock ) /* PRIVILEGED_FUNCTION */
 {
-    BlockLink_t * pxFirstFreeBlock;
-    portPOINTER_SIZE_TYPE uxStartAddress, uxEndAddress;
-    size_t xTotalHeapSize = configTOTAL_HEAP_SIZE;
+    BlockLink_t ** ppxPath[ heapTREE_MAX_HEIGHT ];
+    BlockLink_t ** ppxSlot = &pxTreeRoot;
+    BlockLink_t ** ppxSuccessorSlot;
+    BlockLink_t * pxNode;
+    BlockLink_t * pxSuccessor;
+    UBaseType_t uxDepth = 0, uxBlockDepth;
 
-    /* Ensure the heap starts on a correctly aligned boundary. */
-    uxStartAddress = ( portPOINTER_SIZE_TYPE ) ucHeap;
+    heapSTATS_REMOVE_FREE_BLOCK( pxBlock->xBlockSize );
 
-    if( ( uxStartAddress & portBYTE_ALIGNMENT_MASK ) != 0 )
+    /* Find the slot that points to the block, remembering the path. */
+    for( pxNode = heapTREE_LOAD( ppxSlot ); pxNode != pxBlock; pxNode = heapTREE_LOAD( ppxSlot ) )
     {
-        uxStartAddress += ( portBYTE_ALIGNMENT - 1 );
-        uxStartAddress &= ~( ( portPOINTER_SIZE_TYPE ) portBYTE_ALIGNMENT_MASK );
-        xTotalHeapSize -= ( size_t ) ( uxStartAddress - ( portPOINTER_SIZE_TYPE ) ucHeap );
+        configASSERT( pxNode != NULL );
+        heapVALIDATE_BLOCK_POINTER( pxNode );
+        configASSERT( uxDepth < heapTREE_MAX_HEIGHT );
+        ppxPath[ uxDepth ] = ppxSlot;
+        uxDepth++;
+        ppxSlot = prvTreeChildSlot( pxNode, pxBlock );
     }
 
-    #if ( configENABLE_HEAP_PROTECTOR == 1 )
+    if( heapTREE_LEFT( pxBlock ) == NULL )
     {
-        vApplicationGetRandomHeapCanary( &( xHeapCanary ) );
+        heapTREE_STORE( ppxSlot, heapTREE_RIGHT( pxBlock ) );
     }
-    #endif
+    else if( heapTREE_RIGHT( pxBlock ) == NULL )
+    {
+        heapTREE_STORE( ppxSlot, heapTREE_LEFT( pxBlock ) );
+    }
+    else
+    {
+        /* The block has two children, so it is replaced by its successor, the
+         * leftmost node of its right subtree. */
+        uxBlockDepth = uxDepth;
+        ppxPath[ uxDepth ] = ppxSlot;
+        uxDepth++;
 
-    /* xStart is used to hold a pointer to the first item in the list of free
-     * blocks.  The void cast is used to prevent compiler warnings. */
-    xStart.pxNextFreeBlock = ( void * ) heapPROTECT_BLOCK_POINTER( uxStartAddress );
-    xStart.xBlockSize = ( size_t ) 0;
+        ppxSuccessorSlot = heapTREE_RIGHT_SLOT( pxBlock );
 
-    /* pxEnd is used to mark the end of the list of free blocks and is inserted
-     * at the end of the heap space. */
-    uxEndAddress = uxStartAddress + ( portPOINTER_SIZE_TYPE ) xTotalHeapSize;
-    uxEndAddress -= ( portPOINTER_SIZE_TYPE ) xHeapStructSize;
-    uxEndAddress &= ~( ( portPOINTER_SIZE_TYPE ) portBYTE_ALIGNMENT_MASK );
-    pxEnd = ( BlockLink_t * ) uxEndAddress;
-    pxEnd->xBlockSize = 0;
-    pxEnd->pxNextFreeBlock = heapPROTECT_BLOCK_POINTER( NULL );
+        while( heapTREE_LEFT( heapTREE_LOAD( ppxSuccessorSlot ) ) != NULL )
+        {
+            configASSERT( uxDepth < heapTREE_MAX_HEIGHT );
+            ppxPath[ uxDepth ] = ppxSuccessorSlot;
+            uxDepth++;
+            ppxSuccessorSlot = heapTREE_LEFT_SLOT( heapTREE_LOAD( ppxSuccessorSlot ) );
+        }
 
-    /* To start with there is a single free block that is sized to take up the
-     * entire heap space, minus the space taken by pxEnd. */
-    pxFirstFreeBlock = ( BlockLink_t * ) uxStartAddress;
-    pxFirstFreeBlock->xBlockSize = ( size_t ) ( uxEndAddress - ( portPOINTER_SIZE_TYPE ) pxFirstFreeBlock );
-    pxFirstFreeBlock->pxNextFreeBlock = heapPROTECT_BLOCK_POINTER( pxEnd );
+        pxSuccessor = heapTREE_LOAD( ppxSuccessorSlot );
+        heapTREE_STORE( ppxSuccessorSlot, heapTREE_RIGHT( pxSuccessor ) );
+
+        heapTREE_SET_LEFT( pxSuccessor, heapTREE_LEFT( pxBlock ) );
+        heapTREE_SET_RIGHT( pxSuccessor, heapTREE_RIGHT( pxBlock ) );
+        heapTREE_HEIGHT( pxSuccessor ) = heapTREE_HEIGHT( pxBlock );
+        heapTREE_STORE( ppxSlot, pxSuccessor );
+
+        /* The path down to the successor went through the right slot of the
+         * block, which is now the right slot of the successor. */
+        if( uxDepth > ( uxBlockDepth + 1U ) )
+        {
+            ppxPath[ uxBlockDepth + 1U ] = heapTREE_RIGHT_SLOT( pxSuccessor );
+        }
+        else
+        {
+            mtCOVERAGE_TEST_MARKER();
+        }
+    }
 
-    /* Only one block exists - and it covers the entire usable heap space. */
-    xMinimumEverFreeBytesRemaining = pxFirstFreeBlock->xBlockSize;
-    xFreeBytesRemaining = pxFirstFreeBlock->xBlockSize;
+    while( uxDepth > 0U )
+    {
+        uxDepth--;
+        heapTREE_STORE( ppxPath[ uxDepth ], prvTreeBalance( heapTREE_LOAD( ppxPath[ uxDepth ] ) ) );
+    }
 }
 /*-----------------------------------------------------------*/
 
-static void prvInsertBlockIntoFreeList( BlockLink_t * pxBlockToInsert ) /* PRIVILEGED_FUNCTION */
+static BlockLink_t * prvFindFreeBlock( size_t xWantedSize ) /* PRIVILEGED_FUNCTION */
 {
-    BlockLink_t * pxIterator;
-    uint8_t * puc;
+    BlockLink_t * pxNode = heapTREE_LOAD( &pxTreeRoot );
+    BlockLink_t * pxBlock = NULL;
 
-    /* Iterate through the list until a block is found that has a higher address
-     * than the block being inserted. */
-    for( pxIterator = &xStart; heapPROTECT_BLOCK_POINTER( pxIterator->pxNextFreeBlock ) < pxBlockToInsert; pxIterator = heapPROTECT_BLOCK_POINTER( pxIterator->pxNextFreeBlock ) )
+    /* Keep the smallest block seen that is large enough, then look for a
+     * smaller one on its left.  At most one iteration per level of the
+     * tree. */
+    while( pxNode != NULL )
     {
-        /* Nothing to do here, just iterate to the right position. */
-    }
+        heapVALIDATE_BLOCK_POINTER( pxNode );
+        heapPERF_VISIT();
 
-    if( pxIterator != &xStart )
-    {
-        heapVALIDATE_BLOCK_POINTER( pxIterator );
+        if( pxNode->xBlockSize >= xWantedSize )
+        {
+            pxBlock = pxNode;
+            pxNode = heapTREE_LEFT( pxNode );
+        }
+        else
+        {
+            pxNode = heapTREE_RIGHT( pxNode );
+        }
     }
 
-    /* Do the block being inserted, and the block it is being inserted after
-     * make a contiguous block of memory? */
-    puc = ( uint8_t * ) pxIterator;
+    return pxBlock;
+}
 
-    if( ( puc + pxIterator->xBlockSize ) == ( uint8_t * ) pxBlockToInsert )
+#endif /* heapUSE_BEST_FIT_TREE */
+/*-----------------------------------------------------------*/
+
+#if ( configHEAP_INCREMENTAL_STATS == 1 )
+
+static void prvStatsAddFreeBlock( size_t xSize ) /* PRIVILEGED_FUNCTION */
+{
+    UBaseType_t uxClass = ( UBaseType_t ) heapFLS( xSize );
+
+    xNumberOfFreeBlocks++;
+    xFreeBlocksPerClass[ uxClass ]++;
+    ulFreeBlockClassBitmap |= ( ( uint32_t ) 1U ) << uxClass;
+}
+/*-----------------------------------------------------------*/
+
+static void prvStatsRemoveFreeBlock( size_t xSize ) /* PRIVILEGED_FUNCTION */
+{
+    UBaseType_t uxClass = ( UBaseType_t ) heapFLS( xSize );
+
+    configASSERT( xFreeBlocksPerClass[ uxClass ] > 0U );
+
+    xNumberOfFreeBlocks--;
+    xFreeBlocksPerClass[ uxClass ]--;
+
+    if( xFreeBlocksPerClass[ uxClass ] == 0U )
     {
-        pxIterator->xBlockSize += pxBlockToInsert->xBlockSize;
-        pxBlockToInsert = pxIterator;
+        ulFreeBlockClassBitmap &= ~( ( ( uint32_t ) 1U ) << uxClass );
     }
     else
     {
         mtCOVERAGE_TEST_MARKER();
     }
+}
+/*-----------------------------------------------------------*/
 
-    /* Do the block being inserted, and the block it is being inserted before
-     * make a contiguous block of memory? */
-    puc = ( uint8_t * ) pxBlockToInsert;
-
-    if( ( puc + pxBlockToInsert->xBlockSize ) == ( uint8_t * ) heapPROTECT_BLOCK_POINTER( pxIterator->pxNextFreeBlock ) )
+void vPortGetHeapStats( HeapStats_t * pxHeapStats )
+{
+    /* Every figure is kept up to date by pvPortMalloc() and vPortFree(), so
+     * they only need to be copied.  The largest and smallest free blocks are
+     * known to the size class they belong to. */
+    taskENTER_CRITICAL();
     {
-        if( heapPROTECT_BLOCK_POINTER( pxIterator->pxNextFreeBlock ) != pxEnd )
+        if( ulFreeBlockClassBitmap != 0U )
         {
-            /* Form one big block from the two blocks. */
-            pxBlockToInsert->xBlockSize += heapPROTECT_BLOCK_POINTER( pxIterator->pxNextFreeBlock )->xBlockSize;
-            pxBlockToInsert->pxNextFreeBlock = heapPROTECT_BLOCK_POINTER( pxIterator->pxNextFreeBlock )->pxNextFreeBlock;
+            pxHeapStats->xSizeOfLargestFreeBlockInBytes = ( ( size_t ) 1 ) << heapFLS( ulFreeBlockClassBitmap );
+            pxHeapStats->xSizeOfSmallestFreeBlockInBytes = ( ( size_t ) 1 ) << heapFFS( ulFreeBlockClassBitmap );
         }
         else
         {
-            pxBlockToInsert->pxNextFreeBlock = heapPROTECT_BLOCK_POINTER( pxEnd );
+            pxHeapStats->xSizeOfLargestFreeBlockInBytes = 0;
+            pxHeapStats->xSizeOfSmallestFreeBlockInBytes = portMAX_DELAY; /* portMAX_DELAY used as a portable way of getting the maximum value. */
         }
-    }
-    else
-    {
-        pxBlockToInsert->pxNextFreeBlock = pxIterator->pxNextFreeBlock;
-    }
 
-    /* If the block being inserted plugged a gab, so was merged with the block
-     * before and the block after, then it's pxNextFreeBlock pointer will have
-     * already been set, and should not be set here as that would make it point
-     * to itself. */
-    if( pxIterator != pxBlockToInsert )
-    {
-        pxIterator->pxNextFreeBlock = heapPROTECT_BLOCK_POINTER( pxBlockToInsert );
-    }
-    else
-    {
-        mtCOVERAGE_TEST_MARKER();
+        pxHeapStats->xNumberOfFreeBlocks = xNumberOfFreeBlocks;
+        pxHeapStats->xAvailableHeapSpaceInBytes = xFreeBytesRemaining;
+        pxHeapStats->xNumberOfSuccessfulAllocations = xNumberOfSuccessfulAllocations;
+        pxHeapStats->xNumberOfSuccessfulFrees = xNumberOfSuccessfulFrees;
+        pxHeapStats->xMinimumEverFreeBytesRemaining = xMinimumEverFreeBytesRemaining;
     }
+    taskEXIT_CRITICAL();
 }
-/*-----------------------------------------------------------*/
+
+#else /* configHEAP_INCREMENTAL_STATS */
 
 void vPortGetHeapStats( HeapStats_t * pxHeapStats )
 {
     BlockLink_t * pxBlock;
     size_t xBlocks = 0, xMaxSize = 0, xMinSize = portMAX_DELAY; /* portMAX_DELAY used as a portable way of getting the maximum value. */
 
+    #if ( heapUSE_SEGREGATED_LISTS == 1 )
+        UBaseType_t uxIndex;
+    #elif ( heapUSE_BEST_FIT_TREE == 1 )
+        BlockLink_t * pxPendingNodes[ heapTREE_MAX_HEIGHT ];
+        UBaseType_t uxPending = 0;
+    #endif
+
+    #if ( configHEAP_PERF_COUNTERS == 1 )
+        uint32_t ulSuspendStart;
+    #endif
+
     vTaskSuspendAll();
     {
-        pxBlock = heapPROTECT_BLOCK_POINTER( xStart.pxNextFreeBlock );
+        heapPERF_TIMESTAMP( ulSuspendStart );
 
-        /* pxBlock will be NULL if the heap has not been initialised.  The heap
-         * is initialised automatically when the first allocation is made. */
-        if( pxBlock != NULL )
+        #if ( heapUSE_SEGREGATED_LISTS == 1 )
         {
-            while( pxBlock != pxEnd )
+            /* Walk every segregated list.  The lists are all empty if the heap
+             * has not been initialised yet. */
+            for( uxIndex = 0; uxIndex < heapFREE_LIST_COUNT; uxIndex++ )
             {
-                /* Increment the number of blocks and record the largest block seen
-                 * so far. */
-                xBlocks++;
-
-                if( pxBlock->xBlockSize > xMaxSize )
+                for( pxBlock = pxFreeLists[ uxIndex ]; pxBlock != NULL; pxBlock = heapPROTECT_BLOCK_POINTER( pxBlock->pxNextFreeBlock ) )
                 {
-                    xMaxSize = pxBlock->xBlockSize;
+                    xBlocks++;
+
+                    if( pxBlock->xBlockSize > xMaxSize )
+                    {
+                        xMaxSize = pxBlock->xBlockSize;
+                    }
+
+                    if( pxBlock->xBlockSize < xMinSize )
+                    {
+                        xMinSize = pxBlock->xBlockSize;
+                    }
                 }
+            }
+        }
+        #elif ( heapUSE_BEST_FIT_TREE == 1 )
+        {
+            /* Visit every node of the tree, depth first.  At most one right
+             * subtree per level is left pending. */
+            if( pxEnd != NULL )
+            {
+                pxBlock = heapTREE_LOAD( &pxTreeRoot );
 
-                if( pxBlock->xBlockSize < xMinSize )
+                while( ( pxBlock != NULL ) || ( uxPending > 0U ) )
                 {
-                    xMinSize = pxBlock->xBlockSize;
+                    if( pxBlock == NULL )
+                    {
+                        uxPending--;
+                        pxBlock = pxPendingNodes[ uxPending ];
+                    }
+
+                    xBlocks++;
+
+                    if( pxBlock->xBlockSize > xMaxSize )
+                    {
+                        xMaxSize = pxBlock->xBlockSize;
+                    }
+
+                    if( pxBlock->xBlockSize < xMinSize )
+                    {
+                        xMinSize = pxBlock->xBlockSize;
+                    }
+
+                    if( heapTREE_RIGHT( pxBlock ) != NULL )
+                    {
+                        configASSERT( uxPending < heapTREE_MAX_HEIGHT );
+                        pxPendingNodes[ uxPending ] = heapTREE_RIGHT( pxBlock );
+                        uxPending++;
+                    }
+
+                    pxBlock = heapTREE_LEFT( pxBlock );
                 }
+            }
+        }
+        #else /* heapUSE_SEGREGATED_LISTS */
+        {
+            pxBlock = heapPROTECT_BLOCK_POINTER( xStart.pxNextFreeBlock );
 
-                /* Move to the next block in the chain until the last block is
-                 * reached. */
-                pxBlock = heapPROTECT_BLOCK_POINTER( pxBlock->pxNextFreeBlock );
+            /* pxBlock will be NULL if the heap has not been initialised.  The heap
+             * is initialised automatically when the first allocation is made. */
+            if( pxBlock != NULL )
+            {
+                while( pxBlock != pxEnd )
+                {
+                    /* With configHEAP_USE_REGIONS there is a zero sized block at
+                     * the end of each region - the block is only used to link
+                     * to the next heap region so it is not a real block. */
+                    if( pxBlock->xBlockSize != 0U )
+                    {
+                        /* Increment the number of blocks and record the largest
+                         * block seen so far. */
+                        xBlocks++;
+
+                        if( pxBlock->xBlockSize > xMaxSize )
+                        {
+                            xMaxSize = pxBlock->xBlockSize;
+                        }
+
+                        if( pxBlock->xBlockSize < xMinSize )
+                        {
+                            xMinSize = pxBlock->xBlockSize;
+                        }
+                    }
+
+                    /* Move to the next block in the chain until the last block is
+                     * reached. */
+                    pxBlock = heapPROTECT_BLOCK_POINTER( pxBlock->pxNextFreeBlock );
+                }
             }
         }
+        #endif /* heapUSE_SEGREGATED_LISTS */
+
+        heapPERF_SUSPENDED_DONE( ulSuspendStart );
     }
     ( void ) xTaskResumeAll();
 
@@ -673,4 +5104,111 @@ void vPortGetHeapStats( HeapStats_t * pxHeapStats )
     }
     taskEXIT_CRITICAL();
 }
+
+#endif /* configHEAP_INCREMENTAL_STATS */
+/*-----------------------------------------------------------*/
+
+#if ( configHEAP_PERF_COUNTERS == 1 )
+
+static uint32_t prvPerfGetCycles( void ) /* PRIVILEGED_FUNCTION */
+{
+    if( xCycleCounterStarted == pdFALSE )
+    {
+        configHEAP_PERF_START_CYCLE_COUNTER();
+        xCycleCounterStarted = pdTRUE;
+    }
+    else
+    {
+        mtCOVERAGE_TEST_MARKER();
+    }
+
+    return configHEAP_PERF_GET_CYCLE_COUNT();
+}
+/*-----------------------------------------------------------*/
+
+static void prvPerfRecordSearch( void ) /* PRIVILEGED_FUNCTION */
+{
+    UBaseType_t uxBucket = 0U;
+    size_t xVisited = xBlocksVisited;
+
+    /* The bucket is one more than the index of the most significant bit set,
+     * so each one covers twice the range of the one before. */
+    while( ( xVisited > 0U ) && ( uxBucket < ( heapPERF_SEARCH_BUCKETS - 1U ) ) )
+    {
+        xVisited >>= 1;
+        uxBucket++;
+    }
+
+    xPerfStats.xSearchHistogram[ uxBucket ]++;
+
+    if( xBlocksVisited > xPerfStats.xMaximumBlocksVisited )
+    {
+        xPerfStats.xMaximumBlocksVisited = xBlocksVisited;
+    }
+    else
+    {
+        mtCOVERAGE_TEST_MARKER();
+    }
+}
+/*-----------------------------------------------------------*/
+
+static void prvPerfRecordCall( HeapPerfCallStats_t * pxCallStats,
+                               uint32_t ulCallStart,
+                               uint32_t ulSuspendStart ) /* PRIVILEGED_FUNCTION */
+{
+    /* Unsigned subtraction copes with the counter wrapping around once. */
+    uint32_t ulCallCycles = prvPerfGetCycles() - ulCallStart;
+
+    pxCallStats->xNumberOfCalls++;
+    pxCallStats->ullTotalCycles += ulCallCycles;
+
+    if( ulCallCycles > pxCallStats->ulMaximumCycles )
+    {
+        pxCallStats->ulMaximumCycles = ulCallCycles;
+    }
+    else
+    {
+        mtCOVERAGE_TEST_MARKER();
+    }
+
+    prvPerfRecordSuspended( ulSuspendStart );
+}
+/*-----------------------------------------------------------*/
+
+static void prvPerfRecordSuspended( uint32_t ulSuspendStart ) /* PRIVILEGED_FUNCTION */
+{
+    uint32_t ulSuspendedCycles = prvPerfGetCycles() - ulSuspendStart;
+
+    if( ulSuspendedCycles > xPerfStats.ulMaximumSuspendedCycles )
+    {
+        xPerfStats.ulMaximumSuspendedCycles = ulSuspendedCycles;
+    }
+    else
+    {
+        mtCOVERAGE_TEST_MARKER();
+    }
+}
+/*-----------------------------------------------------------*/
+
+void vPortGetHeapPerfStats( HeapPerfStats_t * pxHeapPerfStats )
+{
+    /* The counters are only written with the scheduler suspended. */
+    vTaskSuspendAll();
+    {
+        *pxHeapPerfStats = xPerfStats;
+    }
+    ( void ) xTaskResumeAll();
+}
+/*-----------------------------------------------------------*/
+
+void vPortResetHeapPerfStats( void )
+{
+    vTaskSuspendAll();
+    {
+        ( void ) memset( &xPerfStats, 0, sizeof( xPerfStats ) );
+    }
+    ( void ) xTaskResumeAll();
+}
+
+#endif /* configHEAP_PERF_COUNTERS */
 /*-----------------------------------------------------------*/
@@ -0,0 +1,417 @@
+/*
+ * FreeRTOS Kernel <DEVELOPMENT BRANCH>
+ * Copyright (C) 2021 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+/*
+ * Functions of heap_4_revised.c that are not part of the standard portable
+ * layer API declared in portable.h.
+ */
+
+#ifndef HEAP_4_REVISED_H
+#define HEAP_4_REVISED_H
+
+#include "FreeRTOS.h"
+#include "task.h"
+
+/* Set configHEAP_ISR_BLOCK_COUNT to reserve that many blocks of
+ * configHEAP_ISR_BLOCK_SIZE bytes for pvPortMallocFromISR() when the heap is
+ * initialised. */
+#ifndef configHEAP_ISR_BLOCK_COUNT
+    #define configHEAP_ISR_BLOCK_COUNT    0
+#endif
+
+#ifndef configHEAP_ISR_BLOCK_SIZE
+    #define configHEAP_ISR_BLOCK_SIZE    64
+#endif
+
+/* Set configHEAP_USE_REGIONS to 1 to build the heap from the (at most
+ * configHEAP_MAX_REGIONS) memory regions passed to vPortDefineHeapRegions(),
+ * as heap_5.c does.  Region configHEAP_FAST_REGION of the array is the one
+ * pvPortMallocWithHint() favours for eHeapHintFast requests. */
+#ifndef configHEAP_USE_REGIONS
+    #define configHEAP_USE_REGIONS    0
+#endif
+
+#ifndef configHEAP_MAX_REGIONS
+    #define configHEAP_MAX_REGIONS    4
+#endif
+
+#ifndef configHEAP_FAST_REGION
+    #define configHEAP_FAST_REGION    0
+#endif
+
+/* Set configHEAP_TASK_ACCOUNTING to 1 to charge every block to the task that
+ * allocated it, and let xPortSetTaskHeapQuota() limit what a task may hold.
+ * At most configHEAP_MAX_ACCOUNTED_TASKS - 1 tasks are accounted for
+ * separately at a time. */
+#ifndef configHEAP_TASK_ACCOUNTING
+    #define configHEAP_TASK_ACCOUNTING    0
+#endif
+
+#ifndef configHEAP_MAX_ACCOUNTED_TASKS
+    #define configHEAP_MAX_ACCOUNTED_TASKS    8
+#endif
+
+/* Set configHEAP_FAST_BIN_COUNT to cache up to configHEAP_FAST_BIN_DEPTH freed
+ * blocks of each of the configHEAP_FAST_BIN_COUNT smallest block sizes, one
+ * size per multiple of portBYTE_ALIGNMENT, unmerged.  The next request of the
+ * same size takes the most recently freed one back without searching.  The
+ * cached blocks are merged back into the heap when a search fails, and by
+ * vPortHeapIdleMaintenance(). */
+#ifndef configHEAP_FAST_BIN_COUNT
+    #define configHEAP_FAST_BIN_COUNT    0
+#endif
+
+#ifndef configHEAP_FAST_BIN_DEPTH
+    #define configHEAP_FAST_BIN_DEPTH    4
+#endif
+
+/* Set configHEAP_DEFERRED_COALESCING to 1 for vPortFree() to only push the
+ * block on a list of pending frees, in constant time, instead of merging it
+ * into the heap.  vPortHeapIdleMaintenance() merges
+ * configHEAP_DEFERRED_MERGE_BATCH of them per call, and a search that fails
+ * merges them all before it gives up. */
+#ifndef configHEAP_DEFERRED_COALESCING
+    #define configHEAP_DEFERRED_COALESCING    0
+#endif
+
+#ifndef configHEAP_DEFERRED_MERGE_BATCH
+    #define configHEAP_DEFERRED_MERGE_BATCH    8
+#endif
+
+/* Set configHEAP_PREZERO_FREE_BLOCKS to 1 to keep the free memory of the heap
+ * zeroed.  vPortFree() pushes the block on the list of pending frees, as with
+ * deferred coalescing and without clearing it, and
+ * vPortHeapIdleMaintenance() zeroes up to configHEAP_PREZERO_BYTES_PER_CALL
+ * bytes of them per call before it merges them.  pvPortCalloc() then only
+ * clears the few bytes that held the links of the block it is given. */
+#ifndef configHEAP_PREZERO_FREE_BLOCKS
+    #define configHEAP_PREZERO_FREE_BLOCKS    0
+#endif
+
+#ifndef configHEAP_PREZERO_BYTES_PER_CALL
+    #define configHEAP_PREZERO_BYTES_PER_CALL    256
+#endif
+
+/* Set configHEAP_USE_HANDLES to 1 for xHeapHandleAlloc(), whose blocks are
+ * reached through one of configHEAP_MAX_HANDLES handles rather than through a
+ * pointer, so the heap may move them while they are not locked.  A search that
+ * fails then slides the unlocked blocks down into the free space below them
+ * before it gives up, and vPortHeapIdleMaintenance() moves one of them per
+ * call. */
+#ifndef configHEAP_USE_HANDLES
+    #define configHEAP_USE_HANDLES    0
+#endif
+
+#ifndef configHEAP_MAX_HANDLES
+    #define configHEAP_MAX_HANDLES    8
+#endif
+
+/* Set configHEAP_PERF_COUNTERS to 1 to have pvPortMalloc() and vPortFree()
+ * count the free blocks each search looks at and the cycles each call and
+ * each suspension of the scheduler takes, for vPortGetHeapPerfStats().  The
+ * cycles are read from the DWT cycle counter, or from CMSDK dual timer 1 when
+ * configHEAP_PERF_USE_CMSDK_TIMER is 1, as QEMU does not model the DWT.
+ * Another counter can be given with configHEAP_PERF_GET_CYCLE_COUNT() and
+ * configHEAP_PERF_START_CYCLE_COUNTER(). */
+#ifndef configHEAP_PERF_COUNTERS
+    #define configHEAP_PERF_COUNTERS    0
+#endif
+
+#ifndef configHEAP_PERF_USE_CMSDK_TIMER
+    #define configHEAP_PERF_USE_CMSDK_TIMER    0
+#endif
+
+/* Where pvPortMallocWithHint() should place a block. */
+typedef enum
+{
+    eHeapHintAny = 0, /* Any region, as pvPortMalloc(). */
+    eHeapHintFast,    /* Hot data, favour the fast region. */
+    eHeapHintBulk     /* Bulk data, favour the other regions. */
+} eHeapPlacementHint;
+
+/* Expected lifetime of a block, for pvPortMallocWithLifetime(). */
+typedef enum
+{
+    eHeapLifetimeTransient = 0, /* Freed soon, placed as by pvPortMalloc(). */
+    eHeapLifetimeLong           /* Kept for long, or for ever, taken from the high end of the heap. */
+} eHeapLifetime;
+
+/* Free block search of configHEAP_ALLOCATION_TYPE 8, selected with
+ * xPortSetAllocationPolicy().  The values are those of the matching
+ * configHEAP_ALLOCATION_TYPE. */
+typedef enum
+{
+    eHeapPolicyFirstFit = 0,
+    eHeapPolicyBestFit = 1,
+    eHeapPolicyWorstFit = 2,
+    eHeapPolicyNextFit = 6
+} eHeapAllocationPolicy;
+
+/* Usage of one heap region, returned by vPortGetHeapRegionStats(). */
+typedef struct xHeapRegionStats
+{
+    uint8_t * pucStartAddress;             /* The first byte of the region that is used by the heap. */
+    size_t xSizeInBytes;                   /* The number of bytes of the region the heap can hand out. */
+    size_t xAvailableHeapSpaceInBytes;     /* The total heap size currently available in the region - this is the sum of all the free blocks, not the largest block that can be allocated. */
+    size_t xMinimumEverFreeBytesRemaining; /* The minimum amount of free memory there has been in the region since the system booted. */
+    size_t xNumberOfSuccessfulAllocations; /* The number of calls to pvPortMalloc() that returned a block of the region. */
+    size_t xNumberOfSuccessfulFrees;       /* The number of calls to vPortFree() that returned a block to the region. */
+} HeapRegionStats_t;
+
+/* Heap usage of one task, returned by uxPortGetTaskHeapStats().  Sizes are
+ * those of the blocks, headers included, as in xPortGetFreeHeapSize(), or the
+ * object size for the objects of a pool. */
+typedef struct xTaskHeapStats
+{
+    TaskHandle_t xHandle;                  /* The task, or NULL for the blocks allocated outside of any task, before the scheduler started, by the tasks that did not fit in the table, and those left by a deleted task. */
+    size_t xCurrentBytes;                  /* The number of bytes of the blocks the task holds. */
+    size_t xPeakBytes;                     /* The maximum of xCurrentBytes since the task was first accounted for. */
+    size_t xQuotaBytes;                    /* The limit set with xPortSetTaskHeapQuota(), or 0 if there is none. */
+    size_t xNumberOfSuccessfulAllocations; /* The number of blocks pvPortMalloc() gave to the task. */
+    size_t xNumberOfSuccessfulFrees;       /* The number of the blocks of the task that were freed, by any task. */
+    size_t xNumberOfQuotaFailures;         /* The number of calls to pvPortMalloc() that failed because of the quota. */
+} TaskHeapStats_t;
+
+/* A block of xHeapHandleAlloc(), which may move while it is not locked. */
+typedef struct xHeapHandle * HeapHandle_t;
+
+/* Bucket 0 of xSearchHistogram counts the searches that looked at no free
+ * block, bucket n those that looked at 2^(n-1) to 2^n - 1 of them, and the
+ * last bucket everything above. */
+#define heapPERF_SEARCH_BUCKETS    8
+
+/* Cycles spent in one of the allocator functions. */
+typedef struct xHeapPerfCallStats
+{
+    size_t xNumberOfCalls;    /* The number of calls measured. */
+    uint64_t ullTotalCycles;  /* The sum of their cycles, divide by xNumberOfCalls for the average. */
+    uint32_t ulMaximumCycles; /* The slowest of them. */
+} HeapPerfCallStats_t;
+
+/* Performance counters of the allocator, returned by vPortGetHeapPerfStats()
+ * next to the HeapStats_t of vPortGetHeapStats(). */
+typedef struct xHeapPerfStats
+{
+    HeapPerfCallStats_t xMallocCalls;                      /* Calls to pvPortMalloc(), failed ones included. */
+    HeapPerfCallStats_t xFreeCalls;                        /* Calls to vPortFree() that gave a block back to the heap, not to a pool. */
+    uint32_t ulMaximumSuspendedCycles;                     /* The longest time any heap function kept the scheduler suspended. */
+    size_t xSearchHistogram[ heapPERF_SEARCH_BUCKETS ];    /* The number of free blocks the searches of pvPortMalloc() looked at, see heapPERF_SEARCH_BUCKETS. */
+    size_t xMaximumBlocksVisited;                          /* The most free blocks one call to pvPortMalloc() looked at. */
+} HeapPerfStats_t;
+
+/*
+ * Resize the memory pv points to, returned by pvPortMalloc(), to xWantedSize
+ * bytes, keeping its contents up to the smaller of the two sizes.  The block
+ * shrinks in place, and grows in place when the block that follows it is
+ * free and large enough.  Otherwise a new block is allocated, the contents
+ * copied and pv freed.  Returns the new address, or NULL, leaving pv as it
+ * is, if there is no room.  As with realloc(), a NULL pv allocates and an
+ * xWantedSize of 0 frees.
+ */
+void * pvPortRealloc( void * pv,
+                      size_t xWantedSize );
+
+/*
+ * Allocate xWantedSize bytes like pvPortMalloc(), taking eHeapLifetimeLong
+ * blocks from the high end of the heap so they do not end up between the
+ * transient blocks, which the allocation policy places from the low end.  The
+ * free space then stays in one piece between the two.  The block is freed
+ * with vPortFree().
+ */
+void * pvPortMallocWithLifetime( size_t xWantedSize,
+                                 eHeapLifetime eLifetime );
+
+/*
+ * Set the low watermark of xPortGetMinimumEverFreeHeapSize(), and of the
+ * regions, to the memory free now, as in upstream heap_4.c, for example once
+ * an initialisation phase that is not representative has run.
+ */
+void xPortResetHeapMinimumEverFreeHeapSize( void );
+
+/*
+ * Housekeeping for the idle task, to call from vApplicationIdleHook(): merge
+ * the blocks cached in the fast bins back into the heap, and the next
+ * configHEAP_DEFERRED_MERGE_BATCH pending frees of deferred coalescing, or
+ * zero the next configHEAP_PREZERO_BYTES_PER_CALL bytes of them when the free
+ * memory is kept zeroed, then move one unlocked block of xHeapHandleAlloc()
+ * down.  Does nothing if none of these is enabled.
+ */
+void vPortHeapIdleMaintenance( void );
+
+#if ( configHEAP_ALLOCATION_TYPE != 7 )
+
+/*
+ * Allocate xWantedSize bytes like pvPortMalloc(), at an address that is a
+ * multiple of xAlignment, a power of two, for example for a DMA buffer or an
+ * MPU region.  The memory in front of the block is left free.  The block is
+ * freed with vPortFree().  pvPortRealloc() only keeps the alignment while the
+ * block can be resized in place.  Not available with the buddy system, whose
+ * blocks cannot start at an arbitrary address.
+ */
+    void * pvPortMallocAligned( size_t xWantedSize,
+                                size_t xAlignment );
+
+#endif /* configHEAP_ALLOCATION_TYPE != 7 */
+
+#if ( configHEAP_ALLOCATION_TYPE == 8 )
+
+/*
+ * Select how pvPortMalloc() chooses among the free blocks from now on.  Blocks
+ * that are already allocated are not affected.  Returns pdFAIL, and keeps the
+ * current policy, if ePolicy is not one of eHeapAllocationPolicy.  The policy
+ * is first-fit until this is called.
+ */
+    BaseType_t xPortSetAllocationPolicy( eHeapAllocationPolicy ePolicy );
+    eHeapAllocationPolicy ePortGetAllocationPolicy( void );
+
+#endif /* configHEAP_ALLOCATION_TYPE */
+
+#if ( configHEAP_USE_REGIONS == 1 )
+
+/*
+ * Allocate xWantedSize bytes like pvPortMalloc(), looking first in the region
+ * that eHint asks for and only then in the other regions.
+ */
+    void * pvPortMallocWithHint( size_t xWantedSize,
+                                 eHeapPlacementHint eHint );
+
+/*
+ * Number of regions passed to vPortDefineHeapRegions(), which keep their
+ * index in the array.
+ */
+    UBaseType_t uxPortGetNumberOfHeapRegions( void );
+
+/*
+ * Return the usage of region uxRegion in *pxRegionStats.  vPortGetHeapStats()
+ * still reports the whole heap.
+ */
+    void vPortGetHeapRegionStats( UBaseType_t uxRegion,
+                                  HeapRegionStats_t * pxRegionStats );
+
+#endif /* configHEAP_USE_REGIONS */
+
+#if ( configHEAP_TASK_ACCOUNTING == 1 )
+
+/*
+ * Limit the bytes that xTask, or the calling task if xTask is NULL, may hold
+ * to xQuotaBytes, or remove the limit if xQuotaBytes is 0.  An allocation that
+ * would take the task over its quota fails as if the heap were full, and a
+ * pvPortRealloc() that would do so moves the block.  Blocks the task already
+ * holds are not affected.  Returns pdFAIL if the table of accounted tasks is
+ * full.
+ */
+    BaseType_t xPortSetTaskHeapQuota( TaskHandle_t xTask,
+                                      size_t xQuotaBytes );
+
+/*
+ * Forget xTask, which is being deleted, so that a task later created with the
+ * same TCB address does not inherit its quota and counters.  FreeRTOSConfig.h
+ * calls it from traceTASK_DELETE(); an application that defines that macro
+ * itself must call it there too, or at least remove the quota of the task with
+ * xPortSetTaskHeapQuota( xTask, 0 ) before vTaskDelete().  The entry of a task
+ * deleted while still holding blocks is reported with a NULL xHandle until
+ * the last of them is freed.
+ */
+    void vPortReleaseTaskHeapStats( TaskHandle_t xTask );
+
+/*
+ * Fill pxTaskHeapStatsArray with the heap usage of every task accounted for,
+ * as uxTaskGetSystemState() does with the task states.  Returns the number of
+ * entries written, or 0 if uxArraySize is too small to hold them all.  An
+ * array of configHEAP_MAX_ACCOUNTED_TASKS entries is always large enough.
+ */
+    UBaseType_t uxPortGetTaskHeapStats( TaskHeapStats_t * const pxTaskHeapStatsArray,
+                                        const UBaseType_t uxArraySize );
+
+#endif /* configHEAP_TASK_ACCOUNTING */
+
+#if ( configHEAP_ISR_BLOCK_COUNT > 0 )
+
+/*
+ * Interrupt safe allocation.  pvPortMallocFromISR() returns one of the blocks
+ * reserved for interrupts if xWantedSize is not larger than
+ * configHEAP_ISR_BLOCK_SIZE, or NULL if the request is too large, all the
+ * reserved blocks are in use or the heap has not been initialised yet by a
+ * first call to pvPortMalloc().  It never blocks and never masks interrupts.
+ *
+ * A reserved block is given back with vPortFreeFromISR(), or with vPortFree()
+ * from a task.
+ */
+    void * pvPortMallocFromISR( size_t xWantedSize );
+    void vPortFreeFromISR( void * pv );
+
+#endif /* configHEAP_ISR_BLOCK_COUNT */
+
+#if ( configHEAP_USE_HANDLES == 1 )
+
+/*
+ * Allocate xWantedSize bytes like pvPortMalloc(), never from an object pool,
+ * and return a handle to them, or NULL if the heap or the table of
+ * configHEAP_MAX_HANDLES handles is full.  The block may be moved by the heap
+ * whenever it is not locked, so it must not hold pointers into itself, and it
+ * is only given back with vHeapHandleFree(), never with vPortFree() or
+ * pvPortRealloc().
+ */
+    HeapHandle_t xHeapHandleAlloc( size_t xWantedSize );
+
+/*
+ * Free the block of xHandle, which must not be locked, and the handle itself.
+ * A NULL xHandle is ignored.
+ */
+    void vHeapHandleFree( HeapHandle_t xHandle );
+
+/*
+ * Pin the block of xHandle where it is and return its address, which stays
+ * valid until the matching vHeapHandleUnlock().  Locks nest, the block may
+ * move again once every lock has been released.
+ */
+    void * pvHeapHandleLock( HeapHandle_t xHandle );
+    void vHeapHandleUnlock( HeapHandle_t xHandle );
+
+/*
+ * Merge the blocks cached in the fast bins and the pending frees, then slide
+ * the unlocked blocks of xHeapHandleAlloc() down until none of them has free
+ * space below it.  Returns pdTRUE if a block moved.  Buddy blocks cannot start
+ * at an arbitrary address, so with configHEAP_ALLOCATION_TYPE 7 nothing moves.
+ */
+    BaseType_t xPortHeapCompact( void );
+
+#endif /* configHEAP_USE_HANDLES */
+
+#if ( configHEAP_PERF_COUNTERS == 1 )
+
+/*
+ * Copy the performance counters into *pxHeapPerfStats, or clear them, for
+ * example to measure one phase of the application on its own.
+ */
+    void vPortGetHeapPerfStats( HeapPerfStats_t * pxHeapPerfStats );
+    void vPortResetHeapPerfStats( void );
+
+#endif /* configHEAP_PERF_COUNTERS */
+
+#endif /* HEAP_4_REVISED_H */
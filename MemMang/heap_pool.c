@@ -0,0 +1,434 @@
+/*
+ * FreeRTOS Kernel <DEVELOPMENT BRANCH>
+ * Copyright (C) 2021 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+/*
+ * Fixed size object pools (slabs) for heap_4_revised.c.
+ *
+ * Each pool is a single heap block cut into objects of the same size.  Free
+ * objects are kept in a singly linked list threaded through their first word,
+ * so an object has no BlockLink_t header and is allocated and freed in
+ * constant time.  Objects of kernel structures that are created and deleted
+ * over and over, such as task control blocks and stacks, then no longer
+ * fragment the heap.
+ *
+ * With configHEAP_TASK_ACCOUNTING set to 1 the storage of a pool is followed
+ * by an array with one word per object, in which heap_4_revised.c keeps the
+ * task the object is charged to.
+ */
+#include <string.h>
+
+/* Defining MPU_WRAPPERS_INCLUDED_FROM_API_FILE prevents task.h from redefining
+ * all the API functions to use the MPU wrappers.  That should only be done when
+ * task.h is included from an application file. */
+#define MPU_WRAPPERS_INCLUDED_FROM_API_FILE
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include "heap_pool.h"
+
+#undef MPU_WRAPPERS_INCLUDED_FROM_API_FILE
+
+#if ( configHEAP_USE_POOLS == 1 )
+
+#ifndef configHEAP_CLEAR_MEMORY_ON_FREE
+    #define configHEAP_CLEAR_MEMORY_ON_FREE    0
+#endif
+
+/* Max value that fits in a size_t type. */
+#define poolSIZE_MAX    ( ~( ( size_t ) 0 ) )
+
+/* Check if multiplying a and b will result in overflow. */
+#define poolMULTIPLY_WILL_OVERFLOW( a, b )    ( ( ( a ) > 0 ) && ( ( b ) > ( poolSIZE_MAX / ( a ) ) ) )
+
+/* The first word of a free object points to the next free object. */
+#define poolNEXT_FREE_OBJECT( pvObject )      ( *( ( void ** ) ( pvObject ) ) )
+
+typedef struct xPool
+{
+    uint8_t * pucStorage;    /**< The first object of the pool. */
+    uint8_t * pucStorageEnd; /**< The first byte after the last object. */
+    void * pvFreeList;       /**< The first free object, NULL if the pool is empty. */
+    PoolStats_t xStats;      /**< Object size and occupancy. */
+
+    #if ( configHEAP_TASK_ACCOUNTING == 1 )
+        void ** ppvOwners;   /**< The owner of each object, see ppvPortPoolGetOwner(). */
+    #endif
+} Pool_t;
+
+/*-----------------------------------------------------------*/
+
+/* The pools, sorted by increasing object size. */
+PRIVILEGED_DATA static Pool_t xPools[ configHEAP_MAX_POOLS ];
+PRIVILEGED_DATA static UBaseType_t uxNumberOfPools = 0U;
+
+/* Set while xPortPoolCreate() allocates the storage of a pool, so the storage
+ * comes from the heap and not from a pool that already exists. */
+PRIVILEGED_DATA static BaseType_t xCreatingPool = pdFALSE;
+
+/*-----------------------------------------------------------*/
+
+BaseType_t xPortPoolCreate( size_t xObjectSize,
+                            size_t xNumberOfObjects )
+{
+    BaseType_t xReturn = pdFAIL;
+    uint8_t * pucStorage = NULL;
+    Pool_t * pxPool;
+    UBaseType_t uxIndex;
+    size_t xObject;
+    size_t xStorageSize = 0U;
+
+    /* Every object must be able to hold the free list link and must keep the
+     * object that follows it aligned. */
+    if( xObjectSize < sizeof( void * ) )
+    {
+        xObjectSize = sizeof( void * );
+    }
+    else
+    {
+        mtCOVERAGE_TEST_MARKER();
+    }
+
+    if( ( xObjectSize & portBYTE_ALIGNMENT_MASK ) != 0x00 )
+    {
+        xObjectSize += portBYTE_ALIGNMENT - ( xObjectSize & portBYTE_ALIGNMENT_MASK );
+    }
+    else
+    {
+        mtCOVERAGE_TEST_MARKER();
+    }
+
+    if( ( xNumberOfObjects > 0U ) && ( poolMULTIPLY_WILL_OVERFLOW( xObjectSize, xNumberOfObjects ) == 0 ) )
+    {
+        xStorageSize = xObjectSize * xNumberOfObjects;
+
+        #if ( configHEAP_TASK_ACCOUNTING == 1 )
+        {
+            if( ( poolMULTIPLY_WILL_OVERFLOW( sizeof( void * ), xNumberOfObjects ) == 0 ) &&
+                ( ( sizeof( void * ) * xNumberOfObjects ) <= ( poolSIZE_MAX - xStorageSize ) ) )
+            {
+                xStorageSize += sizeof( void * ) * xNumberOfObjects;
+            }
+            else
+            {
+                xStorageSize = 0U;
+            }
+        }
+        #endif /* configHEAP_TASK_ACCOUNTING */
+    }
+    else
+    {
+        mtCOVERAGE_TEST_MARKER();
+    }
+
+    if( xStorageSize > 0U )
+    {
+        vTaskSuspendAll();
+        {
+            if( uxNumberOfPools < ( UBaseType_t ) configHEAP_MAX_POOLS )
+            {
+                xCreatingPool = pdTRUE;
+                pucStorage = ( uint8_t * ) pvPortMalloc( xStorageSize );
+                xCreatingPool = pdFALSE;
+            }
+            else
+            {
+                mtCOVERAGE_TEST_MARKER();
+            }
+
+            if( pucStorage != NULL )
+            {
+                /* Keep the pools sorted by object size, as uxPortGetNumberOfPools()
+                 * documents. */
+                for( uxIndex = uxNumberOfPools; ( uxIndex > 0U ) && ( xPools[ uxIndex - 1U ].xStats.xObjectSize > xObjectSize ); uxIndex-- )
+                {
+                    xPools[ uxIndex ] = xPools[ uxIndex - 1U ];
+                }
+
+                pxPool = &( xPools[ uxIndex ] );
+                pxPool->pucStorage = pucStorage;
+                pxPool->pucStorageEnd = pucStorage + ( xObjectSize * xNumberOfObjects );
+
+                /* Thread every object on the free list, lowest address
+                 * first. */
+                pxPool->pvFreeList = NULL;
+
+                for( xObject = xNumberOfObjects; xObject > 0U; xObject-- )
+                {
+                    poolNEXT_FREE_OBJECT( pucStorage + ( ( xObject - 1U ) * xObjectSize ) ) = pxPool->pvFreeList;
+                    pxPool->pvFreeList = ( void * ) ( pucStorage + ( ( xObject - 1U ) * xObjectSize ) );
+                }
+
+                pxPool->xStats.xObjectSize = xObjectSize;
+                pxPool->xStats.xNumberOfObjects = xNumberOfObjects;
+                pxPool->xStats.xNumberOfFreeObjects = xNumberOfObjects;
+                pxPool->xStats.xMinimumEverFreeObjects = xNumberOfObjects;
+                pxPool->xStats.xNumberOfSuccessfulAllocations = 0U;
+                pxPool->xStats.xNumberOfSuccessfulFrees = 0U;
+
+                #if ( configHEAP_TASK_ACCOUNTING == 1 )
+                {
+                    pxPool->ppvOwners = ( void ** ) pxPool->pucStorageEnd;
+                    ( void ) memset( pxPool->ppvOwners, 0x00, sizeof( void * ) * xNumberOfObjects );
+                }
+                #endif /* configHEAP_TASK_ACCOUNTING */
+
+                uxNumberOfPools++;
+                xReturn = pdPASS;
+            }
+            else
+            {
+                mtCOVERAGE_TEST_MARKER();
+            }
+        }
+        ( void ) xTaskResumeAll();
+    }
+    else
+    {
+        mtCOVERAGE_TEST_MARKER();
+    }
+
+    return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+void * pvPortPoolMalloc( size_t xWantedSize,
+                         size_t xMaximumSize )
+{
+    void * pvReturn = NULL;
+    Pool_t * pxPool;
+    UBaseType_t uxIndex;
+
+    /* Round the request up as xPortPoolCreate() rounds the object size.  A
+     * request of zero bytes stays 0 and is not served. */
+    if( ( xWantedSize > 0U ) && ( xWantedSize < sizeof( void * ) ) )
+    {
+        xWantedSize = sizeof( void * );
+    }
+    else if( ( xWantedSize & portBYTE_ALIGNMENT_MASK ) != 0x00 )
+    {
+        if( xWantedSize <= ( poolSIZE_MAX - portBYTE_ALIGNMENT ) )
+        {
+            xWantedSize += portBYTE_ALIGNMENT - ( xWantedSize & portBYTE_ALIGNMENT_MASK );
+        }
+        else
+        {
+            /* No pool can have objects that large. */
+            xWantedSize = 0U;
+        }
+    }
+    else
+    {
+        mtCOVERAGE_TEST_MARKER();
+    }
+
+    vTaskSuspendAll();
+    {
+        if( ( xCreatingPool == pdFALSE ) && ( xWantedSize > 0U ) )
+        {
+            /* Find a pool whose objects are exactly the size of the request,
+             * so a request of another size cannot drain it.  At most
+             * configHEAP_MAX_POOLS iterations. */
+            for( uxIndex = 0U; ( uxIndex < uxNumberOfPools ) && ( xPools[ uxIndex ].xStats.xObjectSize < xWantedSize ); uxIndex++ )
+            {
+                /* Nothing to do here, just iterate to the right pool. */
+            }
+
+            if( ( uxIndex < uxNumberOfPools ) && ( xPools[ uxIndex ].xStats.xObjectSize != xWantedSize ) )
+            {
+                uxIndex = uxNumberOfPools;
+            }
+            else
+            {
+                mtCOVERAGE_TEST_MARKER();
+            }
+
+            /* An empty pool leaves the request to the heap, and so does a
+             * pool whose objects are larger than the caller may take. */
+            if( ( uxIndex < uxNumberOfPools ) && ( xPools[ uxIndex ].pvFreeList != NULL ) &&
+                ( xPools[ uxIndex ].xStats.xObjectSize <= xMaximumSize ) )
+            {
+                pxPool = &( xPools[ uxIndex ] );
+                pvReturn = pxPool->pvFreeList;
+                pxPool->pvFreeList = poolNEXT_FREE_OBJECT( pvReturn );
+
+                pxPool->xStats.xNumberOfFreeObjects--;
+
+                if( pxPool->xStats.xNumberOfFreeObjects < pxPool->xStats.xMinimumEverFreeObjects )
+                {
+                    pxPool->xStats.xMinimumEverFreeObjects = pxPool->xStats.xNumberOfFreeObjects;
+                }
+                else
+                {
+                    mtCOVERAGE_TEST_MARKER();
+                }
+
+                pxPool->xStats.xNumberOfSuccessfulAllocations++;
+            }
+            else
+            {
+                mtCOVERAGE_TEST_MARKER();
+            }
+        }
+        else
+        {
+            mtCOVERAGE_TEST_MARKER();
+        }
+    }
+    ( void ) xTaskResumeAll();
+
+    return pvReturn;
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xPortPoolFree( void * pv )
+{
+    BaseType_t xReturn = pdFALSE;
+    Pool_t * pxPool;
+    UBaseType_t uxIndex;
+
+    if( pv != NULL )
+    {
+        vTaskSuspendAll();
+        {
+            /* The address of the object tells which pool, if any, it belongs
+             * to.  At most configHEAP_MAX_POOLS iterations. */
+            for( uxIndex = 0U; ( uxIndex < uxNumberOfPools ) && ( xReturn == pdFALSE ); uxIndex++ )
+            {
+                pxPool = &( xPools[ uxIndex ] );
+
+                if( ( ( uint8_t * ) pv >= pxPool->pucStorage ) && ( ( uint8_t * ) pv < pxPool->pucStorageEnd ) )
+                {
+                    configASSERT( ( ( size_t ) ( ( uint8_t * ) pv - pxPool->pucStorage ) % pxPool->xStats.xObjectSize ) == 0U );
+                    configASSERT( pxPool->xStats.xNumberOfFreeObjects < pxPool->xStats.xNumberOfObjects );
+
+                    #if ( configHEAP_CLEAR_MEMORY_ON_FREE == 1 )
+                    {
+                        ( void ) memset( pv, 0, pxPool->xStats.xObjectSize );
+                    }
+                    #endif
+
+                    poolNEXT_FREE_OBJECT( pv ) = pxPool->pvFreeList;
+                    pxPool->pvFreeList = pv;
+
+                    pxPool->xStats.xNumberOfFreeObjects++;
+                    pxPool->xStats.xNumberOfSuccessfulFrees++;
+                    xReturn = pdTRUE;
+                }
+                else
+                {
+                    mtCOVERAGE_TEST_MARKER();
+                }
+            }
+        }
+        ( void ) xTaskResumeAll();
+    }
+    else
+    {
+        mtCOVERAGE_TEST_MARKER();
+    }
+
+    return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+size_t xPortPoolGetObjectSize( const void * pv )
+{
+    size_t xReturn = 0U;
+    UBaseType_t uxIndex;
+
+    vTaskSuspendAll();
+    {
+        /* At most configHEAP_MAX_POOLS iterations. */
+        for( uxIndex = 0U; ( uxIndex < uxNumberOfPools ) && ( xReturn == 0U ); uxIndex++ )
+        {
+            if( ( ( const uint8_t * ) pv >= xPools[ uxIndex ].pucStorage ) && ( ( const uint8_t * ) pv < xPools[ uxIndex ].pucStorageEnd ) )
+            {
+                xReturn = xPools[ uxIndex ].xStats.xObjectSize;
+            }
+            else
+            {
+                mtCOVERAGE_TEST_MARKER();
+            }
+        }
+    }
+    ( void ) xTaskResumeAll();
+
+    return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+#if ( configHEAP_TASK_ACCOUNTING == 1 )
+
+void ** ppvPortPoolGetOwner( const void * pv )
+{
+    void ** ppvReturn = NULL;
+    UBaseType_t uxIndex;
+
+    vTaskSuspendAll();
+    {
+        /* At most configHEAP_MAX_POOLS iterations. */
+        for( uxIndex = 0U; ( uxIndex < uxNumberOfPools ) && ( ppvReturn == NULL ); uxIndex++ )
+        {
+            if( ( ( const uint8_t * ) pv >= xPools[ uxIndex ].pucStorage ) && ( ( const uint8_t * ) pv < xPools[ uxIndex ].pucStorageEnd ) )
+            {
+                ppvReturn = &( xPools[ uxIndex ].ppvOwners[ ( size_t ) ( ( const uint8_t * ) pv - xPools[ uxIndex ].pucStorage ) / xPools[ uxIndex ].xStats.xObjectSize ] );
+            }
+            else
+            {
+                mtCOVERAGE_TEST_MARKER();
+            }
+        }
+    }
+    ( void ) xTaskResumeAll();
+
+    return ppvReturn;
+}
+/*-----------------------------------------------------------*/
+
+#endif /* configHEAP_TASK_ACCOUNTING */
+
+UBaseType_t uxPortGetNumberOfPools( void )
+{
+    return uxNumberOfPools;
+}
+/*-----------------------------------------------------------*/
+
+void vPortGetPoolStats( UBaseType_t uxPoolIndex,
+                        PoolStats_t * pxPoolStats )
+{
+    configASSERT( uxPoolIndex < uxNumberOfPools );
+
+    taskENTER_CRITICAL();
+    {
+        *pxPoolStats = xPools[ uxPoolIndex ].xStats;
+    }
+    taskEXIT_CRITICAL();
+}
+/*-----------------------------------------------------------*/
+
+#endif /* configHEAP_USE_POOLS */
@@ -0,0 +1,117 @@
+/*
+ * FreeRTOS Kernel <DEVELOPMENT BRANCH>
+ * Copyright (C) 2021 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+/*
+ * Fixed size object pools served by pvPortMalloc() and vPortFree() in
+ * heap_4_revised.c.  See heap_pool.c.
+ */
+
+#ifndef HEAP_POOL_H
+#define HEAP_POOL_H
+
+#include "FreeRTOS.h"
+#include "heap_4_revised.h"
+
+/* Set configHEAP_USE_POOLS to 1 to let pvPortMalloc() serve requests from the
+ * object pools created with xPortPoolCreate(). */
+#ifndef configHEAP_USE_POOLS
+    #define configHEAP_USE_POOLS    0
+#endif
+
+/* Maximum number of pools that can be created. */
+#ifndef configHEAP_MAX_POOLS
+    #define configHEAP_MAX_POOLS    4
+#endif
+
+/* Occupancy of one pool, returned by vPortGetPoolStats(). */
+typedef struct xPoolStats
+{
+    size_t xObjectSize;                    /* The size of every object of the pool, in bytes. */
+    size_t xNumberOfObjects;               /* The number of objects the pool was created with. */
+    size_t xNumberOfFreeObjects;           /* The number of objects that are currently free. */
+    size_t xMinimumEverFreeObjects;        /* The minimum number of free objects there have been in the pool since the system booted. */
+    size_t xNumberOfSuccessfulAllocations; /* The number of calls to pvPortMalloc() that were served by the pool. */
+    size_t xNumberOfSuccessfulFrees;       /* The number of calls to vPortFree() that returned an object to the pool. */
+} PoolStats_t;
+
+#if ( configHEAP_USE_POOLS == 1 )
+
+/*
+ * Carve a pool of xNumberOfObjects objects of xObjectSize bytes from the heap.
+ * xObjectSize is rounded up to a multiple of portBYTE_ALIGNMENT.  From then on
+ * pvPortMalloc() serves a request from the pool only if the request, rounded
+ * up the same way, is exactly the object size, as long as the pool is not
+ * empty, and vPortFree() returns the object to it.  Requests of other sizes go
+ * to the heap, so they cannot drain a pool kept for one kind of object, such
+ * as task control blocks.  Pools are meant to be created at start up and are
+ * never deleted.
+ *
+ * Returns pdPASS if the pool was created, pdFAIL if configHEAP_MAX_POOLS pools
+ * already exist or the heap has no room for it.
+ */
+    BaseType_t xPortPoolCreate( size_t xObjectSize,
+                                size_t xNumberOfObjects );
+
+/*
+ * Number of pools created so far.  Pools are numbered from 0 in increasing
+ * order of object size.
+ */
+    UBaseType_t uxPortGetNumberOfPools( void );
+
+/*
+ * Return the occupancy of pool uxPoolIndex in *pxPoolStats.
+ */
+    void vPortGetPoolStats( UBaseType_t uxPoolIndex,
+                            PoolStats_t * pxPoolStats );
+
+/*
+ * Called by pvPortMalloc(), vPortFree() and pvPortRealloc() - not for use by
+ * the application.  pvPortPoolMalloc() returns NULL if no pool can serve
+ * xWantedSize bytes with objects of at most xMaximumSize bytes,
+ * xPortPoolFree() returns pdFALSE and xPortPoolGetObjectSize() returns 0 if pv
+ * does not belong to a pool.
+ */
+    void * pvPortPoolMalloc( size_t xWantedSize,
+                             size_t xMaximumSize );
+    BaseType_t xPortPoolFree( void * pv );
+    size_t xPortPoolGetObjectSize( const void * pv );
+
+    #if ( configHEAP_TASK_ACCOUNTING == 1 )
+
+/*
+ * Return the word in which heap_4_revised.c keeps the task an object is
+ * charged to, or NULL if pv does not belong to a pool.  Not for use by the
+ * application.
+ */
+        void ** ppvPortPoolGetOwner( const void * pv );
+
+    #endif /* configHEAP_TASK_ACCOUNTING */
+
+#endif /* configHEAP_USE_POOLS */
+
+#endif /* HEAP_POOL_H */
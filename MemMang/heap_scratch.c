@@ -0,0 +1,181 @@
+/*
+ * FreeRTOS Kernel <DEVELOPMENT BRANCH>
+ * Copyright (C) 2021 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+/*
+ * Scratch arenas (mark/release regions) for heap_4_revised.c.
+ *
+ * A task that builds temporary structures on every cycle and frees them all
+ * at the end would pay for a BlockLink_t header, a search and a merge in
+ * prvInsertBlockIntoFreeList() for each of them.  An arena reserves a single
+ * block from the heap instead and hands out its bytes from the low end: an
+ * allocation moves the top of the arena up, and vPortScratchRelease() frees
+ * everything allocated after a mark by moving it back, in constant time.
+ *
+ * An arena is meant to be used by the task that owns it, so unlike the heap
+ * and the pools it is not protected against other tasks.  Share one only
+ * under a lock of the application.
+ */
+#include <string.h>
+
+/* Defining MPU_WRAPPERS_INCLUDED_FROM_API_FILE prevents task.h from redefining
+ * all the API functions to use the MPU wrappers.  That should only be done when
+ * task.h is included from an application file. */
+#define MPU_WRAPPERS_INCLUDED_FROM_API_FILE
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include "heap_4_revised.h"
+#include "heap_scratch.h"
+
+#undef MPU_WRAPPERS_INCLUDED_FROM_API_FILE
+
+#if ( configHEAP_USE_SCRATCH_ARENAS == 1 )
+
+#ifndef configHEAP_CLEAR_MEMORY_ON_FREE
+    #define configHEAP_CLEAR_MEMORY_ON_FREE    0
+#endif
+
+/*-----------------------------------------------------------*/
+
+BaseType_t xPortScratchCreate( ScratchArena_t * pxArena,
+                               size_t xSizeInBytes )
+{
+    BaseType_t xReturn = pdFAIL;
+
+    configASSERT( pxArena != NULL );
+
+    /* Keep whole units of portBYTE_ALIGNMENT only, so the end of the arena
+     * is aligned like every allocation from it. */
+    xSizeInBytes &= ~( ( size_t ) portBYTE_ALIGNMENT_MASK );
+
+    /* The arena usually lives as long as its task, keep it out of the way of
+     * the transient blocks. */
+    pxArena->pucStart = ( xSizeInBytes > 0U ) ? ( uint8_t * ) pvPortMallocWithLifetime( xSizeInBytes, eHeapLifetimeLong ) : NULL;
+
+    if( pxArena->pucStart != NULL )
+    {
+        pxArena->pucEnd = pxArena->pucStart + xSizeInBytes;
+        xReturn = pdPASS;
+    }
+    else
+    {
+        pxArena->pucEnd = NULL;
+    }
+
+    pxArena->pucNext = pxArena->pucStart;
+    pxArena->xMaximumUsedBytes = 0U;
+
+    return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+void vPortScratchDelete( ScratchArena_t * pxArena )
+{
+    configASSERT( pxArena != NULL );
+
+    vPortFree( pxArena->pucStart );
+
+    pxArena->pucStart = NULL;
+    pxArena->pucEnd = NULL;
+    pxArena->pucNext = NULL;
+}
+/*-----------------------------------------------------------*/
+
+void * pvPortScratchMalloc( ScratchArena_t * pxArena,
+                            size_t xWantedSize )
+{
+    void * pvReturn = NULL;
+    size_t xFreeBytes;
+
+    configASSERT( pxArena != NULL );
+
+    xFreeBytes = ( size_t ) ( pxArena->pucEnd - pxArena->pucNext );
+
+    /* Round up to keep the next allocation aligned.  The free space is a
+     * multiple of portBYTE_ALIGNMENT, so a request that fits cannot overflow
+     * when it is rounded. */
+    if( ( xWantedSize > 0U ) && ( xWantedSize <= xFreeBytes ) )
+    {
+        xWantedSize = ( xWantedSize + portBYTE_ALIGNMENT_MASK ) & ~( ( size_t ) portBYTE_ALIGNMENT_MASK );
+
+        pvReturn = ( void * ) pxArena->pucNext;
+        pxArena->pucNext += xWantedSize;
+
+        if( ( size_t ) ( pxArena->pucNext - pxArena->pucStart ) > pxArena->xMaximumUsedBytes )
+        {
+            pxArena->xMaximumUsedBytes = ( size_t ) ( pxArena->pucNext - pxArena->pucStart );
+        }
+        else
+        {
+            mtCOVERAGE_TEST_MARKER();
+        }
+    }
+    else
+    {
+        mtCOVERAGE_TEST_MARKER();
+    }
+
+    return pvReturn;
+}
+/*-----------------------------------------------------------*/
+
+ScratchMark_t xPortScratchMark( const ScratchArena_t * pxArena )
+{
+    configASSERT( pxArena != NULL );
+
+    return ( ScratchMark_t ) ( pxArena->pucNext - pxArena->pucStart );
+}
+/*-----------------------------------------------------------*/
+
+void vPortScratchRelease( ScratchArena_t * pxArena,
+                          ScratchMark_t xMark )
+{
+    configASSERT( pxArena != NULL );
+
+    /* A mark above the top was taken before an earlier release. */
+    configASSERT( xMark <= ( size_t ) ( pxArena->pucNext - pxArena->pucStart ) );
+
+    #if ( configHEAP_CLEAR_MEMORY_ON_FREE == 1 )
+    {
+        ( void ) memset( pxArena->pucStart + xMark, 0, ( size_t ) ( pxArena->pucNext - pxArena->pucStart ) - xMark );
+    }
+    #endif
+
+    pxArena->pucNext = pxArena->pucStart + xMark;
+}
+/*-----------------------------------------------------------*/
+
+size_t xPortScratchGetFreeSize( const ScratchArena_t * pxArena )
+{
+    configASSERT( pxArena != NULL );
+
+    return ( size_t ) ( pxArena->pucEnd - pxArena->pucNext );
+}
+/*-----------------------------------------------------------*/
+
+#endif /* configHEAP_USE_SCRATCH_ARENAS */
@@ -0,0 +1,102 @@
+/*
+ * FreeRTOS Kernel <DEVELOPMENT BRANCH>
+ * Copyright (C) 2021 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+/*
+ * Scratch arenas for temporary allocations, on top of heap_4_revised.c.  See
+ * heap_scratch.c.
+ */
+
+#ifndef HEAP_SCRATCH_H
+#define HEAP_SCRATCH_H
+
+#include "FreeRTOS.h"
+
+/* Set configHEAP_USE_SCRATCH_ARENAS to 1 to build the scratch arena API. */
+#ifndef configHEAP_USE_SCRATCH_ARENAS
+    #define configHEAP_USE_SCRATCH_ARENAS    0
+#endif
+
+/* A block reserved from the heap, handed out from its low end.  The members
+ * are for heap_scratch.c, the application only declares the structure. */
+typedef struct xScratchArena
+{
+    uint8_t * pucStart;       /* The first byte of the reserved block. */
+    uint8_t * pucEnd;         /* The first byte after the reserved block. */
+    uint8_t * pucNext;        /* The first byte not handed out. */
+    size_t xMaximumUsedBytes; /* The most bytes ever handed out at the same time. */
+} ScratchArena_t;
+
+/* A position in an arena, returned by xPortScratchMark(). */
+typedef size_t ScratchMark_t;
+
+#if ( configHEAP_USE_SCRATCH_ARENAS == 1 )
+
+/*
+ * Reserve a block of xSizeInBytes bytes from the heap for *pxArena, as a long
+ * lived block (see pvPortMallocWithLifetime()).  Returns pdPASS, or pdFAIL if
+ * the heap has no room for it.
+ */
+    BaseType_t xPortScratchCreate( ScratchArena_t * pxArena,
+                                   size_t xSizeInBytes );
+
+/*
+ * Give the block of *pxArena back to the heap.  Everything allocated from the
+ * arena is freed with it.
+ */
+    void vPortScratchDelete( ScratchArena_t * pxArena );
+
+/*
+ * Allocate xWantedSize bytes from *pxArena, aligned to portBYTE_ALIGNMENT, by
+ * moving the top of the arena up.  Returns NULL if the arena is full.  The
+ * memory is not freed on its own: vPortScratchRelease() frees everything
+ * allocated after a mark at once.
+ */
+    void * pvPortScratchMalloc( ScratchArena_t * pxArena,
+                                size_t xWantedSize );
+
+/*
+ * Return the current top of *pxArena, for vPortScratchRelease().  The mark
+ * of a new arena, or of one released to 0, is 0.
+ */
+    ScratchMark_t xPortScratchMark( const ScratchArena_t * pxArena );
+
+/*
+ * Free everything allocated from *pxArena since xMark was taken, by moving the
+ * top of the arena back to it.  Marks taken after xMark are no longer valid.
+ */
+    void vPortScratchRelease( ScratchArena_t * pxArena,
+                              ScratchMark_t xMark );
+
+/*
+ * Bytes that can still be allocated from *pxArena.
+ */
+    size_t xPortScratchGetFreeSize( const ScratchArena_t * pxArena );
+
+#endif /* configHEAP_USE_SCRATCH_ARENAS */
+
+#endif /* HEAP_SCRATCH_H */
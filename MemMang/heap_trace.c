@@ -0,0 +1,184 @@
+/*
+ * FreeRTOS Kernel <DEVELOPMENT BRANCH>
+ * Copyright (C) 2021 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+
+/*
+ * Heap event recorder for heap_4_revised.c.
+ *
+ * Every pvPortMalloc() and vPortFree() is stored as a 16 byte record in a ring
+ * buffer of configHEAP_TRACE_RECORDS entries, the oldest record being
+ * overwritten when it is full.  vPortHeapTraceDump() prints the buffer on the
+ * standard output, which is the UART of the demo, so a trace captured on the
+ * target can be replayed under every allocation type on the host with
+ * tools/heap_replay.
+ */
+#include <stdio.h>
+
+/* Defining MPU_WRAPPERS_INCLUDED_FROM_API_FILE prevents task.h from redefining
+ * all the API functions to use the MPU wrappers.  That should only be done when
+ * task.h is included from an application file. */
+#define MPU_WRAPPERS_INCLUDED_FROM_API_FILE
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include "heap_trace.h"
+
+#undef MPU_WRAPPERS_INCLUDED_FROM_API_FILE
+
+#if ( configHEAP_USE_TRACE == 1 )
+
+/*-----------------------------------------------------------*/
+
+/*
+ * Store one record in the ring buffer.
+ */
+static void prvTraceRecord( void * pvAddress,
+                            size_t xSize,
+                            uint32_t ulFreeBit ) PRIVILEGED_FUNCTION;
+
+/*-----------------------------------------------------------*/
+
+/* The ring buffer.  uxTraceNext is the entry the next record goes to, and
+ * ulTraceCount the number of records ever stored. */
+PRIVILEGED_DATA static HeapTraceRecord_t xTraceRecords[ configHEAP_TRACE_RECORDS ];
+PRIVILEGED_DATA static UBaseType_t uxTraceNext = 0U;
+PRIVILEGED_DATA static uint32_t ulTraceCount = 0U;
+
+/*-----------------------------------------------------------*/
+
+void vPortHeapTraceMalloc( void * pvAddress,
+                           size_t xSize )
+{
+    prvTraceRecord( pvAddress, xSize, 0U );
+}
+/*-----------------------------------------------------------*/
+
+void vPortHeapTraceFree( void * pvAddress,
+                         size_t xSize )
+{
+    prvTraceRecord( pvAddress, xSize, heapTRACE_FREE_BITMASK );
+}
+/*-----------------------------------------------------------*/
+
+static void prvTraceRecord( void * pvAddress,
+                            size_t xSize,
+                            uint32_t ulFreeBit ) /* PRIVILEGED_FUNCTION */
+{
+    HeapTraceRecord_t * pxRecord = &( xTraceRecords[ uxTraceNext ] );
+
+    /* The heap calls the trace macros with the scheduler suspended, so the
+     * buffer needs no other protection. */
+    pxRecord->ulTimestamp = ( uint32_t ) xTaskGetTickCount();
+
+    if( xTaskGetSchedulerState() != taskSCHEDULER_NOT_STARTED )
+    {
+        pxRecord->ulTask = ( uint32_t ) ( portPOINTER_SIZE_TYPE ) xTaskGetCurrentTaskHandle();
+    }
+    else
+    {
+        pxRecord->ulTask = 0U;
+    }
+
+    pxRecord->ulAddress = ( uint32_t ) ( portPOINTER_SIZE_TYPE ) pvAddress;
+    pxRecord->ulSize = ( ( uint32_t ) xSize & ~heapTRACE_FREE_BITMASK ) | ulFreeBit;
+
+    uxTraceNext++;
+
+    if( uxTraceNext == ( UBaseType_t ) configHEAP_TRACE_RECORDS )
+    {
+        uxTraceNext = 0U;
+    }
+    else
+    {
+        mtCOVERAGE_TEST_MARKER();
+    }
+
+    ulTraceCount++;
+}
+/*-----------------------------------------------------------*/
+
+void vPortHeapTraceDump( void )
+{
+    const HeapTraceRecord_t * pxRecord;
+    UBaseType_t uxIndex, uxRecords;
+    uint32_t ulLost;
+
+    vTaskSuspendAll();
+    {
+        if( ulTraceCount > ( uint32_t ) configHEAP_TRACE_RECORDS )
+        {
+            /* The buffer wrapped, the oldest record is the next one to be
+             * overwritten. */
+            uxRecords = ( UBaseType_t ) configHEAP_TRACE_RECORDS;
+            uxIndex = uxTraceNext;
+            ulLost = ulTraceCount - ( uint32_t ) configHEAP_TRACE_RECORDS;
+        }
+        else
+        {
+            uxRecords = ( UBaseType_t ) ulTraceCount;
+            uxIndex = 0U;
+            ulLost = 0U;
+        }
+
+        /* The header gives the size of the heap and of a pointer, so the host
+         * can tell how close its replay is to the target. */
+        printf( "@HT begin %u %u %u %u\r\n", ( unsigned int ) uxRecords, ( unsigned int ) ulLost,
+                ( unsigned int ) configTOTAL_HEAP_SIZE, ( unsigned int ) sizeof( void * ) );
+
+        while( uxRecords > 0U )
+        {
+            pxRecord = &( xTraceRecords[ uxIndex ] );
+
+            printf( "@HT %u %x %c %u %x\r\n",
+                    ( unsigned int ) pxRecord->ulTimestamp,
+                    ( unsigned int ) pxRecord->ulTask,
+                    ( ( pxRecord->ulSize & heapTRACE_FREE_BITMASK ) != 0U ) ? 'F' : 'A',
+                    ( unsigned int ) ( pxRecord->ulSize & ~heapTRACE_FREE_BITMASK ),
+                    ( unsigned int ) pxRecord->ulAddress );
+
+            uxIndex++;
+
+            if( uxIndex == ( UBaseType_t ) configHEAP_TRACE_RECORDS )
+            {
+                uxIndex = 0U;
+            }
+            else
+            {
+                mtCOVERAGE_TEST_MARKER();
+            }
+
+            uxRecords--;
+        }
+
+        printf( "@HT end\r\n" );
+    }
+    ( void ) xTaskResumeAll();
+}
+/*-----------------------------------------------------------*/
+
+#endif /* configHEAP_USE_TRACE */
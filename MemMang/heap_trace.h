@@ -0,0 +1,82 @@
+/*
+ * FreeRTOS Kernel <DEVELOPMENT BRANCH>
+ * Copyright (C) 2021 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+
+/*
+ * Recorder of the pvPortMalloc() and vPortFree() calls of heap_4_revised.c,
+ * fed by the traceMALLOC() and traceFREE() macros.  See heap_trace.c.
+ */
+
+#ifndef HEAP_TRACE_H
+#define HEAP_TRACE_H
+
+#include "FreeRTOS.h"
+
+/* Set configHEAP_USE_TRACE to 1, and define traceMALLOC() and traceFREE() as
+ * vPortHeapTraceMalloc() and vPortHeapTraceFree() in FreeRTOSConfig.h, to keep
+ * the last configHEAP_TRACE_RECORDS heap operations in a ring buffer. */
+#ifndef configHEAP_USE_TRACE
+    #define configHEAP_USE_TRACE    0
+#endif
+
+#ifndef configHEAP_TRACE_RECORDS
+    #define configHEAP_TRACE_RECORDS    256
+#endif
+
+/* Set in ulSize for a vPortFree(). */
+#define heapTRACE_FREE_BITMASK    ( 0x80000000UL )
+
+/* One heap operation.  16 bytes. */
+typedef struct xHeapTraceRecord
+{
+    uint32_t ulTimestamp; /* The tick count when the operation completed. */
+    uint32_t ulTask;      /* The handle of the calling task, 0 before the scheduler started. */
+    uint32_t ulAddress;   /* The address returned or freed, 0 for an allocation that failed. */
+    uint32_t ulSize;      /* The size of the block, header included, with heapTRACE_FREE_BITMASK set for a free. */
+} HeapTraceRecord_t;
+
+#if ( configHEAP_USE_TRACE == 1 )
+
+/*
+ * Called by traceMALLOC() and traceFREE() - not for use by the application.
+ * Both run with the scheduler suspended.
+ */
+    void vPortHeapTraceMalloc( void * pvAddress,
+                               size_t xSize );
+    void vPortHeapTraceFree( void * pvAddress,
+                             size_t xSize );
+
+/*
+ * Print the recorded operations, oldest first, as the text lines that
+ * tools/heap_replay reads.  The buffer is left as it is.
+ */
+    void vPortHeapTraceDump( void );
+
+#endif /* configHEAP_USE_TRACE */
+
+#endif /* HEAP_TRACE_H */
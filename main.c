@@ -49,11 +49,14 @@
 /* FreeRTOS includes. */
 #include "FreeRTOS.h"
 #include "task.h"
+#include "heap_4_revised.h"
 
 
 /* Standard includes. */
 #include <stdio.h>
 #include <string.h>
+#include <errno.h>
+#include <stddef.h>
 
 
 /* This project provides seven demo applications:
@@ -103,6 +106,16 @@ extern void main_semaphore2( void );
  */
 static void prvUARTInit( void );
 
+#if ( configHEAP_USE_REGIONS == 1 )
+
+/*
+ * Give heap_4_revised.c its regions: a fast array in .bss, then the RAM the
+ * linker script leaves free between _rtos_heap_bottom and __StackLimit.
+ */
+    static void prvInitialiseHeap( void );
+
+#endif /* configHEAP_USE_REGIONS */
+
 /*-----------------------------------------------------------*/
 
 void main( void )
@@ -113,6 +126,13 @@ void main( void )
     /* Hardware initialisation. printf() output uses the UART for IO. */
     prvUARTInit();
 
+    #if ( configHEAP_USE_REGIONS == 1 )
+    {
+        /* The heap regions must be defined before the first allocation. */
+        prvInitialiseHeap();
+    }
+    #endif
+
     /* The mainCREATE_SIMPLE_DEMO setting is described at the top
      * of this file. It selects the proper demo application */
     #if ( mainCREATE_SIMPLE_DEMO == 1 )
@@ -147,6 +167,37 @@ void main( void )
 }
 /*-----------------------------------------------------------*/
 
+#if ( configHEAP_USE_REGIONS == 1 )
+
+static void prvInitialiseHeap( void )
+{
+    /* Region 0 (configHEAP_FAST_REGION) is favoured by eHeapHintFast
+     * requests.  The MPS2 has a single kind of SRAM, so here it only keeps the
+     * hot buffers together and apart from the bulk data. */
+    static uint8_t ucFastHeap[ configTOTAL_HEAP_SIZE ];
+    extern uint8_t _rtos_heap_bottom[];
+    extern uint8_t __StackLimit[];
+
+    /* The regions must be listed in order of increasing address, and .bss
+     * comes before _rtos_heap_bottom.  The RAM between them is left to the
+     * newlib heap, see _sbrk(). */
+    HeapRegion_t xHeapRegions[] =
+    {
+        { ucFastHeap,        sizeof( ucFastHeap )                           },
+        { _rtos_heap_bottom, ( size_t ) ( __StackLimit - _rtos_heap_bottom ) },
+        { NULL,              0                                              }
+    };
+
+    vPortDefineHeapRegions( xHeapRegions );
+}
+/*-----------------------------------------------------------*/
+
+#endif /* configHEAP_USE_REGIONS */
+
+/* Set by a demo that checks the result of pvPortMalloc() itself and expects it
+ * to fail, so the malloc failed hook returns instead of halting. */
+volatile BaseType_t xMallocFailureExpected = pdFALSE;
+
 void vApplicationMallocFailedHook( void )
 {
     /* vApplicationMallocFailedHook() will only be called if
@@ -162,6 +213,11 @@ void vApplicationMallocFailedHook( void )
      * (although it does not provide information on how the remaining heap might be
      * fragmented).  See http://www.freertos.org/a00111.html for more
      * information. */
+    if( xMallocFailureExpected != pdFALSE )
+    {
+        return;
+    }
+
     printf( "\r\n\r\n Ooops...Malloc failed\r\n" );
     portDISABLE_INTERRUPTS();
 
@@ -182,6 +238,10 @@ void vApplicationIdleHook( void )
      * that vApplicationIdleHook() is permitted to return to its calling function,
      * because it is the responsibility of the idle task to clean up memory
      * allocated by the kernel to any task that has since deleted itself. */
+
+    /* Merge the blocks cached in the heap's fast bins, and some of those whose
+     * merging was deferred, back into the heap. */
+    vPortHeapIdleMaintenance();
 }
 /*-----------------------------------------------------------*/
 
@@ -343,6 +403,34 @@ int __write( int iFile,
 }
 /*-----------------------------------------------------------*/
 
+#if ( configHEAP_USE_LINKER_REGION == 1 ) || ( configHEAP_USE_REGIONS == 1 )
+
+void * _sbrk( ptrdiff_t xIncrement )
+{
+    extern uint8_t _heap_bottom[];
+    extern uint8_t _heap_top[];
+    static uint8_t * pucBreak = _heap_bottom;
+    uint8_t * pucPreviousBreak = pucBreak;
+
+    /* The C library heap (printf() buffers) must stay below _heap_top, as the
+     * RAM above it is the FreeRTOS heap.  The default _sbrk() would only stop
+     * at the stack pointer. */
+    if( ( xIncrement > ( _heap_top - pucBreak ) ) || ( xIncrement < ( _heap_bottom - pucBreak ) ) )
+    {
+        errno = ENOMEM;
+        pucPreviousBreak = ( uint8_t * ) -1;
+    }
+    else
+    {
+        pucBreak += xIncrement;
+    }
+
+    return pucPreviousBreak;
+}
+/*-----------------------------------------------------------*/
+
+#endif /* ( configHEAP_USE_LINKER_REGION == 1 ) || ( configHEAP_USE_REGIONS == 1 ) */
+
 void * malloc( size_t size )
 {
     ( void ) size;
@@ -32,11 +32,17 @@
  * This demo application aims to compare different 
  * Memory Heap Allocation Algorithm.
  * 
- * The different Allocation Algorithms are Firts-Fit, Best-Fit and Worst-Fit.
+ * The different Allocation Algorithms are Firts-Fit, Best-Fit, Worst-Fit,
+ * TLSF (Two-Level Segregated Fit), Segregated-Fit, Next-Fit and Buddy.
  * The Allocation Type can be changed in the FreeRTOSConfig.h file
  * by setting the value of configHEAP_ALLOCATION_TYPE to:
  * 1 -> Best-Fit
  * 2 -> Worst-Fit
+ * 4 -> TLSF
+ * 5 -> Segregated-Fit
+ * 6 -> Next-Fit
+ * 7 -> Buddy
+ * 8 -> First, Best, Worst or Next-Fit, selected at run time
  * any else -> First-Fit
  * 
  *
@@ -62,6 +68,18 @@
  * After each operation, the free heap space and the minimum ever free heap space.
  * When a block cannot be allocated, the system will print an error message
  * defined in the vApplicationMallocFailedHook function in main.c.
+ *
+ * With configHEAP_ALLOCATION_TYPE set to 8 the same sequence is first replayed
+ * under every run time policy, and a table compares the free heap space, the
+ * largest free block and the first step that failed of each policy.  Each
+ * policy replays it twice, with pvPortMalloc() and with pvPortMallocWithLifetime(),
+ * which takes the blocks that are never freed from the high end of the heap.
+ * The heap is emptied after each replay, then the sequence runs once more as
+ * above with First-Fit.
+ *
+ * With configHEAP_TASK_ACCOUNTING set to 1, TASK 1 limits itself to 100 bytes
+ * of heap, allocates 48 bytes twice (the second allocation exceeds the quota)
+ * and prints the heap usage of every task before it deletes itself.
  * 
  * 
  *
@@ -83,6 +101,17 @@
 #include "timers.h"
 
 /* Demo app includes. */
+#include "heap_4_revised.h"
+#include "heap_trace.h"
+#include "heap_scratch.h"
+
+/* Set to 1 to also lay the sequence out at the offsets tools/heap_planner
+computed for it, see main_memManagement_plan.h. */
+#define mainUSE_HEAP_PLAN 0
+
+#if (mainUSE_HEAP_PLAN == 1)
+#include "main_memManagement_plan.h"
+#endif
 
 /*-----------------------------------------------------------*/
 
@@ -110,6 +139,112 @@ constant is different depending on the compiler in use. */
 
 /*-----------------------------------------------------------*/
 
+#if (configHEAP_ALLOCATION_TYPE == 8)
+
+/* One operation of the scripted sequence: allocate xSize bytes into slot uxSlot,
+or free the block in slot uxSlot when xSize is 0.  uxStep is the number of the
+operation in the list at the top of this file.  eLifetime is the hint passed
+to pvPortMallocWithLifetime() when the sequence is replayed with hints: the
+blocks that are freed again are transient, the others are kept. */
+typedef struct
+{
+    size_t xSize;
+    UBaseType_t uxSlot;
+    UBaseType_t uxStep;
+    eHeapLifetime eLifetime;
+} ScriptStep_t;
+
+/* The sequence of main_memManagement().  Creating TASK 1 is replayed as the two
+allocations xTaskCreate() makes, the stack and then the task control block. */
+static const ScriptStep_t xScript[] =
+{
+    {1000, 0, 1, eHeapLifetimeLong},
+    {1000, 1, 2, eHeapLifetimeTransient},
+    {1500, 2, 3, eHeapLifetimeLong},
+    {100, 3, 4, eHeapLifetimeTransient},
+    {100, 4, 5, eHeapLifetimeTransient},
+    {100, 5, 6, eHeapLifetimeTransient},
+    {100, 6, 7, eHeapLifetimeLong},
+    {0, 1, 8, eHeapLifetimeTransient},
+    {0, 3, 9, eHeapLifetimeTransient},
+    {0, 4, 10, eHeapLifetimeTransient},
+    {0, 5, 11, eHeapLifetimeTransient},
+    {300, 1, 12, eHeapLifetimeLong},
+    {1000, 3, 13, eHeapLifetimeLong},
+    {configMINIMAL_STACK_SIZE * sizeof(StackType_t), 7, 14, eHeapLifetimeLong},
+    {sizeof(StaticTask_t), 8, 14, eHeapLifetimeLong}
+};
+
+#define mainSCRIPT_SLOTS 9
+#define mainSCRIPT_STEPS (sizeof(xScript) / sizeof(xScript[0]))
+
+/* The policies compared, and their name in the table. */
+static const eHeapAllocationPolicy xPolicies[] = {eHeapPolicyFirstFit, eHeapPolicyBestFit, eHeapPolicyWorstFit, eHeapPolicyNextFit};
+static const char *const pcPolicyNames[] = {"First-Fit", "Best-Fit", "Worst-Fit", "Next-Fit"};
+
+#define mainNUMBER_OF_POLICIES (sizeof(xPolicies) / sizeof(xPolicies[0]))
+
+/* The malloc failed hook in main.c returns while this is set. */
+extern volatile BaseType_t xMallocFailureExpected;
+
+static void prvComparePolicies(void);
+
+#endif /* configHEAP_ALLOCATION_TYPE == 8 */
+
+#if (configHEAP_TASK_ACCOUNTING == 1)
+
+/* The malloc failed hook in main.c returns while this is set. */
+extern volatile BaseType_t xMallocFailureExpected;
+
+static void prvTaskQuotaDemo(void);
+
+#endif /* configHEAP_TASK_ACCOUNTING == 1 */
+
+#if (configHEAP_USE_SCRATCH_ARENAS == 1)
+
+/* Temporary list node built by prvScratchDemo() on every cycle. */
+typedef struct ScratchNode
+{
+    struct ScratchNode *pxNext;
+    uint32_t ulValue;
+} ScratchNode_t;
+
+#define mainSCRATCH_CYCLES 4
+#define mainSCRATCH_NODES 16
+
+static void prvScratchDemo(void);
+
+#endif /* configHEAP_USE_SCRATCH_ARENAS == 1 */
+
+#if (configHEAP_USE_HANDLES == 1)
+
+#define mainHANDLE_BLOCKS 4
+#define mainHANDLE_BLOCK_SIZE 200
+
+static void prvHandleDemo(void);
+
+#endif /* configHEAP_USE_HANDLES == 1 */
+
+#if (configHEAP_PERF_COUNTERS == 1)
+
+static void prvPrintPerfStats(void);
+
+#endif /* configHEAP_PERF_COUNTERS == 1 */
+
+#if (mainUSE_HEAP_PLAN == 1)
+
+/* The arena the planned blocks are laid out in.  Its size and the offsets come
+from tools/heap_planner/main_memManagement.plan, regenerate the header with
+"make header" in tools/heap_planner when the sequence changes. */
+static uint8_t ucPlanArena[planARENA_SIZE] __attribute__((aligned(portBYTE_ALIGNMENT)));
+
+static void prvPlannedLayout(void);
+static BaseType_t prvBlockHolds(const uint8_t *pucBlock, size_t xSize, uint8_t ucValue);
+
+#endif /* mainUSE_HEAP_PLAN == 1 */
+
+/*-----------------------------------------------------------*/
+
 #include <stdio.h>
 
 void checkHeapUsage(const char *msg, int header_printed)
@@ -134,6 +269,14 @@ void main_memManagement()
 
     void *p1, *p2, *p3, *p4, *p5, *p6, *p7, *p8, *p9, *p10;
 
+#if (configHEAP_ALLOCATION_TYPE == 8)
+    prvComparePolicies();
+#endif
+
+#if (mainUSE_HEAP_PLAN == 1)
+    prvPlannedLayout();
+#endif
+
     checkHeapUsage("Before allocating memory blocks", 0);
 
     // Memory block allocation
@@ -186,6 +329,11 @@ void main_memManagement()
 
     checkHeapUsage("After TASK 1 creation", 1);
 
+#if (configHEAP_USE_TRACE == 1)
+    // Print the recorded heap operations for tools/heap_replay
+    vPortHeapTraceDump();
+#endif
+
     // Inizia il scheduler
     vTaskStartScheduler();
 
@@ -193,6 +341,361 @@ void main_memManagement()
     for (;;);
 }
 
+#if (configHEAP_ALLOCATION_TYPE == 8)
+
+static void prvComparePolicies(void)
+{
+    void *pvBlocks[mainSCRIPT_SLOTS];
+    size_t xFreeHeapSpace[mainNUMBER_OF_POLICIES][2];
+    size_t xLargestFreeBlock[mainNUMBER_OF_POLICIES][2];
+    UBaseType_t uxFailedStep[mainNUMBER_OF_POLICIES][2];
+    HeapStats_t xHeapStats;
+    UBaseType_t uxPolicy, uxHints, uxStep, uxSlot;
+
+    xMallocFailureExpected = pdTRUE;
+
+    for (uxPolicy = 0; uxPolicy < mainNUMBER_OF_POLICIES; uxPolicy++)
+    {
+        /* Replay once with pvPortMalloc(), then once with the lifetime hints. */
+        for (uxHints = 0; uxHints < 2; uxHints++)
+        {
+            /* The heap is empty here, so every replay starts from the same state. */
+            (void)xPortSetAllocationPolicy(xPolicies[uxPolicy]);
+            memset(pvBlocks, 0, sizeof(pvBlocks));
+            uxFailedStep[uxPolicy][uxHints] = 0;
+
+            for (uxStep = 0; uxStep < mainSCRIPT_STEPS; uxStep++)
+            {
+                uxSlot = xScript[uxStep].uxSlot;
+
+                if (xScript[uxStep].xSize != 0)
+                {
+                    if (uxHints == 0)
+                    {
+                        pvBlocks[uxSlot] = pvPortMalloc(xScript[uxStep].xSize);
+                    }
+                    else
+                    {
+                        pvBlocks[uxSlot] = pvPortMallocWithLifetime(xScript[uxStep].xSize, xScript[uxStep].eLifetime);
+                    }
+
+                    if ((pvBlocks[uxSlot] == NULL) && (uxFailedStep[uxPolicy][uxHints] == 0))
+                    {
+                        uxFailedStep[uxPolicy][uxHints] = xScript[uxStep].uxStep;
+                    }
+                }
+                else
+                {
+                    vPortFree(pvBlocks[uxSlot]);
+                    pvBlocks[uxSlot] = NULL;
+                }
+            }
+
+            vPortGetHeapStats(&xHeapStats);
+            xFreeHeapSpace[uxPolicy][uxHints] = xHeapStats.xAvailableHeapSpaceInBytes;
+            xLargestFreeBlock[uxPolicy][uxHints] = xHeapStats.xSizeOfLargestFreeBlockInBytes;
+
+            /* Give everything back before the next replay. */
+            for (uxSlot = 0; uxSlot < mainSCRIPT_SLOTS; uxSlot++)
+            {
+                vPortFree(pvBlocks[uxSlot]);
+            }
+        }
+    }
+
+    xMallocFailureExpected = pdFALSE;
+    (void)xPortSetAllocationPolicy(eHeapPolicyFirstFit);
+
+    /* The replays nearly filled the heap, the sequence below must start from a fresh watermark. */
+    xPortResetHeapMinimumEverFreeHeapSize();
+
+    // Print the combined table
+    printf("%-12s | %-5s | %-17s | %-26s | %-11s\n", "Policy", "Hints", "Free Heap (bytes)", "Largest Free Block (bytes)", "Failed Step");
+    printf("--------------------------------------------------------------------------------------\n");
+
+    for (uxPolicy = 0; uxPolicy < mainNUMBER_OF_POLICIES; uxPolicy++)
+    {
+        for (uxHints = 0; uxHints < 2; uxHints++)
+        {
+            if (uxFailedStep[uxPolicy][uxHints] != 0)
+            {
+                printf("%-12s | %-5s | %-17u | %-26u | %-11u\n", pcPolicyNames[uxPolicy], (uxHints != 0) ? "yes" : "no", (unsigned int)xFreeHeapSpace[uxPolicy][uxHints], (unsigned int)xLargestFreeBlock[uxPolicy][uxHints], (unsigned int)uxFailedStep[uxPolicy][uxHints]);
+            }
+            else
+            {
+                printf("%-12s | %-5s | %-17u | %-26u | %-11s\n", pcPolicyNames[uxPolicy], (uxHints != 0) ? "yes" : "no", (unsigned int)xFreeHeapSpace[uxPolicy][uxHints], (unsigned int)xLargestFreeBlock[uxPolicy][uxHints], "none");
+            }
+        }
+    }
+
+    printf("\n");
+}
+
+#endif /* configHEAP_ALLOCATION_TYPE == 8 */
+
+/*-----------------------------------------------------------*/
+#if (mainUSE_HEAP_PLAN == 1)
+
+static void prvPlannedLayout(void)
+{
+    /* Each block of the sequence is at a fixed place in the arena, so taking
+    one is an addition: no search, no block header, and nothing to give back,
+    as the plan already hands the space of p2, p4, p5 and p6 to p2b and p4b. */
+    uint8_t *p1 = &ucPlanArena[planOFFSET_P1];
+    uint8_t *p2 = &ucPlanArena[planOFFSET_P2];
+    uint8_t *p3 = &ucPlanArena[planOFFSET_P3];
+    uint8_t *p4 = &ucPlanArena[planOFFSET_P4];
+    uint8_t *p5 = &ucPlanArena[planOFFSET_P5];
+    uint8_t *p6 = &ucPlanArena[planOFFSET_P6];
+    uint8_t *p7 = &ucPlanArena[planOFFSET_P7];
+    uint8_t *p2b = &ucPlanArena[planOFFSET_P2B];
+    uint8_t *p4b = &ucPlanArena[planOFFSET_P4B];
+
+    /* Write every block in the order of the sequence, then check that the
+    blocks still live at the end were not overwritten by a later one. */
+    memset(p1, 1, 1000);
+    memset(p2, 2, 1000);
+    memset(p3, 3, 1500);
+    memset(p4, 4, 100);
+    memset(p5, 5, 100);
+    memset(p6, 6, 100);
+    memset(p7, 7, 100);
+    memset(p2b, 12, 300);
+    memset(p4b, 13, 1000);
+
+    configASSERT(prvBlockHolds(p1, 1000, 1) && prvBlockHolds(p3, 1500, 3) && prvBlockHolds(p7, 100, 7));
+    configASSERT(prvBlockHolds(p2b, 300, 12) && prvBlockHolds(p4b, 1000, 13));
+
+    printf("Static plan: arena of %u bytes for the sequence, at most %u bytes live at one step\n\n", (unsigned int)planARENA_SIZE, (unsigned int)planLOWER_BOUND);
+}
+
+static BaseType_t prvBlockHolds(const uint8_t *pucBlock, size_t xSize, uint8_t ucValue)
+{
+    size_t x;
+
+    for (x = 0; x < xSize; x++)
+    {
+        if (pucBlock[x] != ucValue)
+        {
+            return pdFALSE;
+        }
+    }
+
+    return pdTRUE;
+}
+
+#endif /* mainUSE_HEAP_PLAN == 1 */
+
+#if (configHEAP_USE_SCRATCH_ARENAS == 1)
+
+static void prvScratchDemo(void)
+{
+    ScratchArena_t xArena;
+    ScratchMark_t xMark;
+    ScratchNode_t *pxList, *pxNode;
+    HeapStats_t xHeapStats;
+    size_t xAllocationsBefore;
+    UBaseType_t uxCycle, uxNode;
+    uint32_t ulSum = 0;
+
+    if (xPortScratchCreate(&xArena, mainSCRATCH_NODES * sizeof(ScratchNode_t)) == pdFAIL)
+    {
+        printf("Scratch arena: no room in the heap\n\n");
+        return;
+    }
+
+    vPortGetHeapStats(&xHeapStats);
+    xAllocationsBefore = xHeapStats.xNumberOfSuccessfulAllocations;
+
+    /* Each cycle builds a list in the arena and drops all of it with one
+    release, without going through pvPortMalloc() and vPortFree(). */
+    for (uxCycle = 0; uxCycle < mainSCRATCH_CYCLES; uxCycle++)
+    {
+        xMark = xPortScratchMark(&xArena);
+        pxList = NULL;
+
+        for (uxNode = 0; uxNode < mainSCRATCH_NODES; uxNode++)
+        {
+            pxNode = (ScratchNode_t *)pvPortScratchMalloc(&xArena, sizeof(ScratchNode_t));
+            configASSERT(pxNode != NULL);
+            pxNode->ulValue = (uint32_t)((uxCycle * mainSCRATCH_NODES) + uxNode);
+            pxNode->pxNext = pxList;
+            pxList = pxNode;
+        }
+
+        for (pxNode = pxList; pxNode != NULL; pxNode = pxNode->pxNext)
+        {
+            ulSum += pxNode->ulValue;
+        }
+
+        vPortScratchRelease(&xArena, xMark);
+    }
+
+    vPortGetHeapStats(&xHeapStats);
+
+    printf("Scratch arena: %u nodes in %u cycles (sum %u), %u bytes used at most, %u heap allocations\n\n",
+           (unsigned int)(mainSCRATCH_CYCLES * mainSCRATCH_NODES), (unsigned int)mainSCRATCH_CYCLES, (unsigned int)ulSum,
+           (unsigned int)xArena.xMaximumUsedBytes, (unsigned int)(xHeapStats.xNumberOfSuccessfulAllocations - xAllocationsBefore));
+
+    vPortScratchDelete(&xArena);
+}
+
+#endif /* configHEAP_USE_SCRATCH_ARENAS == 1 */
+
+#if (configHEAP_USE_HANDLES == 1)
+
+static void prvHandleDemo(void)
+{
+    HeapHandle_t xHandles[mainHANDLE_BLOCKS];
+    HeapStats_t xHeapStats;
+    size_t xLargestBefore;
+    uint8_t *pucBlock;
+    UBaseType_t uxBlock;
+    BaseType_t xMoved, xIntact = pdTRUE;
+
+    for (uxBlock = 0; uxBlock < mainHANDLE_BLOCKS; uxBlock++)
+    {
+        xHandles[uxBlock] = xHeapHandleAlloc(mainHANDLE_BLOCK_SIZE);
+        configASSERT(xHandles[uxBlock] != NULL);
+
+        pucBlock = (uint8_t *)pvHeapHandleLock(xHandles[uxBlock]);
+        memset(pucBlock, (int)uxBlock, mainHANDLE_BLOCK_SIZE);
+        vHeapHandleUnlock(xHandles[uxBlock]);
+    }
+
+    /* Free every other block, leaving a hole below each of the others, then
+    let the heap slide them down. */
+    for (uxBlock = 0; uxBlock < mainHANDLE_BLOCKS; uxBlock += 2)
+    {
+        vHeapHandleFree(xHandles[uxBlock]);
+    }
+
+    vPortGetHeapStats(&xHeapStats);
+    xLargestBefore = xHeapStats.xSizeOfLargestFreeBlockInBytes;
+
+    xMoved = xPortHeapCompact();
+
+    vPortGetHeapStats(&xHeapStats);
+
+    for (uxBlock = 1; uxBlock < mainHANDLE_BLOCKS; uxBlock += 2)
+    {
+        pucBlock = (uint8_t *)pvHeapHandleLock(xHandles[uxBlock]);
+
+        if ((pucBlock[0] != (uint8_t)uxBlock) || (pucBlock[mainHANDLE_BLOCK_SIZE - 1] != (uint8_t)uxBlock))
+        {
+            xIntact = pdFALSE;
+        }
+
+        vHeapHandleUnlock(xHandles[uxBlock]);
+        vHeapHandleFree(xHandles[uxBlock]);
+    }
+
+    configASSERT(xIntact != pdFALSE);
+
+    printf("Relocatable blocks: %s, largest free block %u -> %u bytes, contents %s\n\n",
+           (xMoved != pdFALSE) ? "compacted" : "nothing to move", (unsigned int)xLargestBefore,
+           (unsigned int)xHeapStats.xSizeOfLargestFreeBlockInBytes, (xIntact != pdFALSE) ? "intact" : "CORRUPTED");
+}
+
+#endif /* configHEAP_USE_HANDLES == 1 */
+
+#if (configHEAP_PERF_COUNTERS == 1)
+
+static void prvPrintPerfStats(void)
+{
+    HeapPerfStats_t xPerfStats;
+    UBaseType_t uxBucket;
+
+    /* Everything the heap did since boot: the demos above and the kernel objects. */
+    vPortGetHeapPerfStats(&xPerfStats);
+
+    printf("%-12s | %-6s | %-14s | %-14s\n", "Function", "Calls", "Average Cycles", "Maximum Cycles");
+    printf("------------------------------------------------------\n");
+    printf("%-12s | %-6u | %-14u | %-14u\n", "pvPortMalloc", (unsigned int)xPerfStats.xMallocCalls.xNumberOfCalls,
+           (xPerfStats.xMallocCalls.xNumberOfCalls != 0) ? (unsigned int)(xPerfStats.xMallocCalls.ullTotalCycles / xPerfStats.xMallocCalls.xNumberOfCalls) : 0U,
+           (unsigned int)xPerfStats.xMallocCalls.ulMaximumCycles);
+    printf("%-12s | %-6u | %-14u | %-14u\n", "vPortFree", (unsigned int)xPerfStats.xFreeCalls.xNumberOfCalls,
+           (xPerfStats.xFreeCalls.xNumberOfCalls != 0) ? (unsigned int)(xPerfStats.xFreeCalls.ullTotalCycles / xPerfStats.xFreeCalls.xNumberOfCalls) : 0U,
+           (unsigned int)xPerfStats.xFreeCalls.ulMaximumCycles);
+    printf("Scheduler suspended for at most %u cycles, at most %u free blocks visited by a search\n",
+           (unsigned int)xPerfStats.ulMaximumSuspendedCycles, (unsigned int)xPerfStats.xMaximumBlocksVisited);
+
+    /* Bucket 0 is a search that visited nothing, bucket n one that visited 2^(n-1) to 2^n - 1 blocks. */
+    printf("Searches per number of blocks visited:");
+
+    for (uxBucket = 0; uxBucket < heapPERF_SEARCH_BUCKETS; uxBucket++)
+    {
+        if (uxBucket <= 1)
+        {
+            printf("%s%u: %u", (uxBucket == 0) ? " " : ", ", (unsigned int)uxBucket, (unsigned int)xPerfStats.xSearchHistogram[uxBucket]);
+        }
+        else if (uxBucket == heapPERF_SEARCH_BUCKETS - 1)
+        {
+            printf(", %u+: %u", 1U << (uxBucket - 1), (unsigned int)xPerfStats.xSearchHistogram[uxBucket]);
+        }
+        else
+        {
+            printf(", %u-%u: %u", 1U << (uxBucket - 1), (1U << uxBucket) - 1U, (unsigned int)xPerfStats.xSearchHistogram[uxBucket]);
+        }
+    }
+
+    printf("\n\n");
+}
+
+#endif /* configHEAP_PERF_COUNTERS == 1 */
+
+#if (configHEAP_TASK_ACCOUNTING == 1)
+
+static void prvTaskQuotaDemo(void)
+{
+    /* Static, the stack of TASK 1 is too small for it. */
+    static TaskHeapStats_t xTaskHeapStats[configHEAP_MAX_ACCOUNTED_TASKS];
+    UBaseType_t uxEntries, uxEntry;
+    void *pvBuffer, *pvOverQuota;
+
+    /* The first block, header included, fits in the quota, the second one
+    would exceed it.  The heap may also be full by now, so neither failure
+    stops the demo. */
+    (void)xPortSetTaskHeapQuota(NULL, 100);
+
+    xMallocFailureExpected = pdTRUE;
+    pvBuffer = pvPortMalloc(48);
+    pvOverQuota = pvPortMalloc(48);
+    xMallocFailureExpected = pdFALSE;
+
+    uxEntries = uxPortGetTaskHeapStats(xTaskHeapStats, configHEAP_MAX_ACCOUNTED_TASKS);
+
+    printf("%-12s | %-13s | %-10s | %-11s | %-14s\n", "Task", "Held (bytes)", "Peak", "Quota", "Quota Failures");
+    printf("------------------------------------------------------------------------------\n");
+
+    for (uxEntry = 0; uxEntry < uxEntries; uxEntry++)
+    {
+        /* Only the handle of the calling task is known to be valid here. */
+        if (xTaskHeapStats[uxEntry].xHandle == xTaskGetCurrentTaskHandle())
+        {
+            printf("%-12s | ", pcTaskGetName(NULL));
+        }
+        else if (xTaskHeapStats[uxEntry].xHandle == NULL)
+        {
+            printf("%-12s | ", "(no task)");
+        }
+        else
+        {
+            printf("%-12p | ", (void *)xTaskHeapStats[uxEntry].xHandle);
+        }
+
+        printf("%-13u | %-10u | %-11u | %-14u\n", (unsigned int)xTaskHeapStats[uxEntry].xCurrentBytes, (unsigned int)xTaskHeapStats[uxEntry].xPeakBytes,
+               (unsigned int)xTaskHeapStats[uxEntry].xQuotaBytes, (unsigned int)xTaskHeapStats[uxEntry].xNumberOfQuotaFailures);
+    }
+
+    printf("\n");
+
+    vPortFree(pvBuffer);
+    vPortFree(pvOverQuota);
+}
+
+#endif /* configHEAP_TASK_ACCOUNTING == 1 */
+
 /*-----------------------------------------------------------*/
 /* TASK FUNCTION WITH vTaskDelayUntil */
 static void vTaskFunction(void *pvParameters)
@@ -206,6 +709,22 @@ static void vTaskFunction(void *pvParameters)
     {
         printf("%s\n", pcTaskMsg);
 
+#if (configHEAP_TASK_ACCOUNTING == 1)
+        prvTaskQuotaDemo();
+#endif
+
+#if (configHEAP_USE_SCRATCH_ARENAS == 1)
+        prvScratchDemo();
+#endif
+
+#if (configHEAP_USE_HANDLES == 1)
+        prvHandleDemo();
+#endif
+
+#if (configHEAP_PERF_COUNTERS == 1)
+        prvPrintPerfStats();
+#endif
+
         /* Delay for a period. */
         vTaskDelayUntil(&ul, mainTASK1_PERIOD_MS);
 
@@ -0,0 +1,21 @@
+/* Generated by tools/heap_planner from main_memManagement.plan, do not edit. */
+
+#ifndef MAIN_MEMMANAGEMENT_PLAN_H
+#define MAIN_MEMMANAGEMENT_PLAN_H
+
+/* Size of the arena, and the most bytes live at one step. */
+#define planARENA_SIZE     3920U
+#define planLOWER_BOUND    3920U
+
+/* Offset of each block in the arena, a multiple of 8. */
+#define planOFFSET_P1     1504U       /* 1000 bytes, steps 1 to the end. */
+#define planOFFSET_P2     2504U       /* 1000 bytes, steps 2 to 8. */
+#define planOFFSET_P3     0U          /* 1500 bytes, steps 3 to the end. */
+#define planOFFSET_P4     3504U       /* 100 bytes, steps 4 to 9. */
+#define planOFFSET_P5     3608U       /* 100 bytes, steps 5 to 10. */
+#define planOFFSET_P6     3712U       /* 100 bytes, steps 6 to 11. */
+#define planOFFSET_P7     3816U       /* 100 bytes, steps 7 to the end. */
+#define planOFFSET_P2B    3504U       /* 300 bytes, steps 12 to the end. */
+#define planOFFSET_P4B    2504U       /* 1000 bytes, steps 13 to the end. */
+
+#endif /* MAIN_MEMMANAGEMENT_PLAN_H */
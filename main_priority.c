@@ -62,6 +62,7 @@
 #include "timers.h"
 
 /* Demo app includes. */
+#include "heap_pool.h"
 
 /*-----------------------------------------------------------*/
 
@@ -94,6 +95,13 @@ constant is different depending on the compiler in use. */
 void main_priority(void)
 {
 
+#if ( configHEAP_USE_POOLS == 1 )
+	/* TCBs and stacks of Task 1, Task 2 and the idle task come from pools, so
+	creating and deleting the tasks does not fragment the heap. */
+	xPortPoolCreate(sizeof(StaticTask_t), 3);
+	xPortPoolCreate(configMINIMAL_STACK_SIZE * sizeof(StackType_t), 3);
+#endif
+
 	/*Start the tasks*/
 	xTaskCreate(vTask2,			  /* The function that implements the task. */
 				"Task 2",				  /* The text name assigned to the task - for debug only as it is not used by the kernel. */
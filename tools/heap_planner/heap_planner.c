@@ -0,0 +1,622 @@
+/*
+ * FreeRTOS Kernel <DEVELOPMENT BRANCH>
+ * Copyright (C) 2021 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+
+/*
+ * Plan, on the host, the memory of an allocation sequence that is known before
+ * the build, such as the start up sequence of main_memManagement().
+ *
+ * The input is a lifetime table, one block per line:
+ *
+ *     <name> <size> <allocation step> <free step, or - if never freed>
+ *
+ * Text after a '#' is a comment.  A block is live from its allocation step up
+ * to, but not including, its free step, so a block allocated at the step
+ * another one is freed can take its place.  The planner gives every block an
+ * offset in one arena so that no two blocks live at the same time overlap,
+ * and keeps the arena as small as it can: blocks are placed at the lowest
+ * offset that is free for their whole lifetime, largest first, and when that
+ * leaves the arena above the lower bound (the most bytes live at one step)
+ * every placement order is searched for tables of up to plannerMAX_SEARCHED
+ * blocks.  At run time the blocks are then taken from a static arena at fixed
+ * offsets, with no search and no block header.
+ *
+ *     heap_planner [-n] [-o header] [-p prefix] [table file]
+ *
+ * The table is read from the standard input when no file is given.  -o writes
+ * the arena size and the offsets to a header, as <prefix>ARENA_SIZE and
+ * <prefix>OFFSET_<NAME> (prefix "plan" by default).  -n leaves out the replay
+ * of the table with the run time policies of heap_4_revised.c, which is
+ * otherwise printed for comparison on a heap of configTOTAL_HEAP_SIZE bytes.
+ */
+
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include "heap_4_revised.h"
+
+/* Largest number of blocks for which every placement order is tried, when
+ * the largest first placement does not reach the lower bound. */
+#define plannerMAX_SEARCHED    10U
+
+/* Free step of a block that is never freed. */
+#define plannerNEVER_FREED     ( ( unsigned long ) -1 )
+
+/* Number of failed steps listed per replay. */
+#define plannerFAILURES_SHOWN  4U
+
+/* Longest block name, and most blocks in a table. */
+#define plannerMAX_NAME        32U
+#define plannerMAX_BLOCKS      256U
+
+/* One block of the lifetime table. */
+typedef struct xPlannerBlock
+{
+    char cName[ plannerMAX_NAME ];
+    size_t xSize;                /* Size asked for. */
+    size_t xPlannedSize;         /* Size rounded up to portBYTE_ALIGNMENT. */
+    unsigned long ulAllocated;   /* Allocation step. */
+    unsigned long ulFreed;       /* Free step, plannerNEVER_FREED if kept. */
+    size_t xOffset;              /* Offset in the arena, once planned. */
+} PlannerBlock_t;
+
+/*-----------------------------------------------------------*/
+
+static PlannerBlock_t xBlocks[ plannerMAX_BLOCKS ];
+static size_t xNumberOfBlocks = 0;
+
+/* Search state: the best order found so far and its arena size. */
+static size_t xSearchOrder[ plannerMAX_SEARCHED ];
+static size_t xBestOrder[ plannerMAX_SEARCHED ];
+static size_t xBestArenaSize;
+static size_t xLowerBound;
+
+/*-----------------------------------------------------------*/
+
+void vTaskSuspendAll( void )
+{
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xTaskResumeAll( void )
+{
+    return pdFALSE;
+}
+/*-----------------------------------------------------------*/
+
+void vAssertCalled( const char * pcFileName,
+                    unsigned long ulLine )
+{
+    fprintf( stderr, "heap_planner: assertion failed in %s line %lu\n", pcFileName, ulLine );
+    abort();
+}
+/*-----------------------------------------------------------*/
+
+static BaseType_t prvLifetimesOverlap( const PlannerBlock_t * pxBlock1,
+                                       const PlannerBlock_t * pxBlock2 )
+{
+    return ( ( pxBlock1->ulAllocated < pxBlock2->ulFreed ) && ( pxBlock2->ulAllocated < pxBlock1->ulFreed ) ) ? pdTRUE : pdFALSE;
+}
+/*-----------------------------------------------------------*/
+
+static void prvReadTable( FILE * pxFile )
+{
+    char cLine[ 256 ];
+    char cName[ plannerMAX_NAME ];
+    char cFreed[ 32 ];
+    char * pcComment;
+    unsigned long ulSize, ulAllocated;
+    unsigned int uxLine = 0;
+    PlannerBlock_t * pxBlock;
+
+    while( fgets( cLine, sizeof( cLine ), pxFile ) != NULL )
+    {
+        uxLine++;
+        pcComment = strchr( cLine, '#' );
+
+        if( pcComment != NULL )
+        {
+            *pcComment = '\0';
+        }
+
+        if( sscanf( cLine, " %31s %lu %lu %31s", cName, &ulSize, &ulAllocated, cFreed ) != 4 )
+        {
+            if( sscanf( cLine, " %31s", cName ) == 1 )
+            {
+                fprintf( stderr, "heap_planner: line %u is not <name> <size> <allocation step> <free step>\n", uxLine );
+                exit( EXIT_FAILURE );
+            }
+
+            /* Blank line or comment. */
+            continue;
+        }
+
+        if( xNumberOfBlocks == plannerMAX_BLOCKS )
+        {
+            fprintf( stderr, "heap_planner: more than %u blocks\n", plannerMAX_BLOCKS );
+            exit( EXIT_FAILURE );
+        }
+
+        pxBlock = &( xBlocks[ xNumberOfBlocks ] );
+        memcpy( pxBlock->cName, cName, sizeof( pxBlock->cName ) );
+        pxBlock->xSize = ( size_t ) ulSize;
+        pxBlock->xPlannedSize = ( ( size_t ) ulSize + portBYTE_ALIGNMENT_MASK ) & ~( ( size_t ) portBYTE_ALIGNMENT_MASK );
+        pxBlock->ulAllocated = ulAllocated;
+        pxBlock->ulFreed = ( strcmp( cFreed, "-" ) == 0 ) ? plannerNEVER_FREED : strtoul( cFreed, NULL, 10 );
+
+        if( ( ulSize == 0U ) || ( pxBlock->ulFreed <= pxBlock->ulAllocated ) )
+        {
+            fprintf( stderr, "heap_planner: line %u has no size or is freed before it is allocated\n", uxLine );
+            exit( EXIT_FAILURE );
+        }
+
+        xNumberOfBlocks++;
+    }
+}
+/*-----------------------------------------------------------*/
+
+static size_t prvComputeLowerBound( void )
+{
+    size_t x, y, xLive, xMaxLive = 0;
+
+    /* The most bytes are live at one of the allocation steps. */
+    for( x = 0; x < xNumberOfBlocks; x++ )
+    {
+        xLive = 0;
+
+        for( y = 0; y < xNumberOfBlocks; y++ )
+        {
+            if( ( xBlocks[ y ].ulAllocated <= xBlocks[ x ].ulAllocated ) && ( xBlocks[ x ].ulAllocated < xBlocks[ y ].ulFreed ) )
+            {
+                xLive += xBlocks[ y ].xPlannedSize;
+            }
+        }
+
+        if( xLive > xMaxLive )
+        {
+            xMaxLive = xLive;
+        }
+    }
+
+    return xMaxLive;
+}
+/*-----------------------------------------------------------*/
+
+static size_t prvLowestOffset( size_t xBlock,
+                               const size_t * pxPlaced,
+                               size_t xNumberPlaced )
+{
+    const PlannerBlock_t * pxBlock = &( xBlocks[ xBlock ] );
+    const PlannerBlock_t * pxOther;
+    size_t xOffset = 0, x;
+    BaseType_t xMoved;
+
+    /* Move the block above every placed block it would overlap, both in time
+     * and in the arena, until it overlaps none.  The offset only grows, so it
+     * settles on the lowest one that fits. */
+    do
+    {
+        xMoved = pdFALSE;
+
+        for( x = 0; x < xNumberPlaced; x++ )
+        {
+            pxOther = &( xBlocks[ pxPlaced[ x ] ] );
+
+            if( ( prvLifetimesOverlap( pxBlock, pxOther ) != pdFALSE ) &&
+                ( xOffset < ( pxOther->xOffset + pxOther->xPlannedSize ) ) &&
+                ( pxOther->xOffset < ( xOffset + pxBlock->xPlannedSize ) ) )
+            {
+                xOffset = pxOther->xOffset + pxOther->xPlannedSize;
+                xMoved = pdTRUE;
+            }
+        }
+    } while( xMoved != pdFALSE );
+
+    return xOffset;
+}
+/*-----------------------------------------------------------*/
+
+static size_t prvPlaceInOrder( const size_t * pxOrder,
+                               size_t xLength )
+{
+    size_t x, xArenaSize = 0;
+
+    for( x = 0; x < xLength; x++ )
+    {
+        xBlocks[ pxOrder[ x ] ].xOffset = prvLowestOffset( pxOrder[ x ], pxOrder, x );
+
+        if( ( xBlocks[ pxOrder[ x ] ].xOffset + xBlocks[ pxOrder[ x ] ].xPlannedSize ) > xArenaSize )
+        {
+            xArenaSize = xBlocks[ pxOrder[ x ] ].xOffset + xBlocks[ pxOrder[ x ] ].xPlannedSize;
+        }
+    }
+
+    return xArenaSize;
+}
+/*-----------------------------------------------------------*/
+
+static void prvSearch( size_t xDepth,
+                       size_t xArenaSize,
+                       uint32_t ulUnplaced )
+{
+    size_t xBlock, xEnd;
+
+    if( ulUnplaced == 0U )
+    {
+        xBestArenaSize = xArenaSize;
+        memcpy( xBestOrder, xSearchOrder, xNumberOfBlocks * sizeof( xSearchOrder[ 0 ] ) );
+        return;
+    }
+
+    /* Every packing can be pushed down, block by block in the order of their
+     * offsets, to one where each block is at the lowest offset left free by
+     * the blocks placed before it, so trying every order finds the smallest
+     * arena. */
+    for( xBlock = 0; ( xBlock < xNumberOfBlocks ) && ( xBestArenaSize > xLowerBound ); xBlock++ )
+    {
+        if( ( ulUnplaced & ( 1UL << xBlock ) ) == 0U )
+        {
+            continue;
+        }
+
+        xBlocks[ xBlock ].xOffset = prvLowestOffset( xBlock, xSearchOrder, xDepth );
+        xEnd = xBlocks[ xBlock ].xOffset + xBlocks[ xBlock ].xPlannedSize;
+
+        if( xEnd < xArenaSize )
+        {
+            xEnd = xArenaSize;
+        }
+
+        if( xEnd < xBestArenaSize )
+        {
+            xSearchOrder[ xDepth ] = xBlock;
+            prvSearch( xDepth + 1U, xEnd, ulUnplaced & ~( 1UL << xBlock ) );
+        }
+    }
+}
+/*-----------------------------------------------------------*/
+
+static int prvCompareSizes( const void * pvBlock1,
+                            const void * pvBlock2 )
+{
+    const PlannerBlock_t * pxBlock1 = &( xBlocks[ *( const size_t * ) pvBlock1 ] );
+    const PlannerBlock_t * pxBlock2 = &( xBlocks[ *( const size_t * ) pvBlock2 ] );
+
+    /* Largest first, then the earliest allocation. */
+    if( pxBlock1->xPlannedSize != pxBlock2->xPlannedSize )
+    {
+        return ( pxBlock1->xPlannedSize > pxBlock2->xPlannedSize ) ? -1 : 1;
+    }
+
+    return ( pxBlock1->ulAllocated < pxBlock2->ulAllocated ) ? -1 : ( ( pxBlock1->ulAllocated > pxBlock2->ulAllocated ) ? 1 : 0 );
+}
+/*-----------------------------------------------------------*/
+
+static BaseType_t prvPlan( void )
+{
+    size_t xOrder[ plannerMAX_BLOCKS ];
+    size_t x, xArenaSize;
+    BaseType_t xOptimal;
+
+    xLowerBound = prvComputeLowerBound();
+
+    for( x = 0; x < xNumberOfBlocks; x++ )
+    {
+        xOrder[ x ] = x;
+    }
+
+    qsort( xOrder, xNumberOfBlocks, sizeof( xOrder[ 0 ] ), prvCompareSizes );
+    xArenaSize = prvPlaceInOrder( xOrder, xNumberOfBlocks );
+    xOptimal = ( xArenaSize == xLowerBound ) ? pdTRUE : pdFALSE;
+
+    if( ( xOptimal == pdFALSE ) && ( xNumberOfBlocks <= plannerMAX_SEARCHED ) )
+    {
+        xBestArenaSize = xArenaSize;
+        memcpy( xBestOrder, xOrder, xNumberOfBlocks * sizeof( xOrder[ 0 ] ) );
+        prvSearch( 0, 0, ( uint32_t ) ( ( 1UL << xNumberOfBlocks ) - 1U ) );
+
+        /* Place the blocks again in the best order, the search left the
+         * offsets of the last order it tried. */
+        ( void ) prvPlaceInOrder( xBestOrder, xNumberOfBlocks );
+        xOptimal = pdTRUE;
+    }
+
+    return xOptimal;
+}
+/*-----------------------------------------------------------*/
+
+static size_t prvArenaSize( void )
+{
+    size_t x, xArenaSize = 0;
+
+    for( x = 0; x < xNumberOfBlocks; x++ )
+    {
+        if( ( xBlocks[ x ].xOffset + xBlocks[ x ].xPlannedSize ) > xArenaSize )
+        {
+            xArenaSize = xBlocks[ x ].xOffset + xBlocks[ x ].xPlannedSize;
+        }
+    }
+
+    return xArenaSize;
+}
+/*-----------------------------------------------------------*/
+
+static void prvReplayWithPolicy( const char * pcPolicy )
+{
+    void * pvBlocks[ plannerMAX_BLOCKS ] = { NULL };
+    HeapStats_t xHeapStats;
+    unsigned long ulStep, ulLastStep = 0;
+    size_t x, xFailures = 0, xInitialFreeBytes, xPeakUsedBytes = 0;
+    char cFailures[ 64 ] = "-";
+    size_t xLength = 0;
+
+    xInitialFreeBytes = xPortGetFreeHeapSize();
+
+    for( x = 0; x < xNumberOfBlocks; x++ )
+    {
+        if( xBlocks[ x ].ulAllocated > ulLastStep )
+        {
+            ulLastStep = xBlocks[ x ].ulAllocated;
+        }
+    }
+
+    /* At each step the frees go first, as the planner lets a block take the
+     * place of one freed at its own step. */
+    for( ulStep = 0; ulStep <= ulLastStep; ulStep++ )
+    {
+        for( x = 0; x < xNumberOfBlocks; x++ )
+        {
+            if( xBlocks[ x ].ulFreed == ulStep )
+            {
+                vPortFree( pvBlocks[ x ] );
+                pvBlocks[ x ] = NULL;
+            }
+        }
+
+        for( x = 0; x < xNumberOfBlocks; x++ )
+        {
+            if( xBlocks[ x ].ulAllocated == ulStep )
+            {
+                pvBlocks[ x ] = pvPortMalloc( xBlocks[ x ].xSize );
+
+                if( pvBlocks[ x ] == NULL )
+                {
+                    if( xFailures < plannerFAILURES_SHOWN )
+                    {
+                        xLength += ( size_t ) snprintf( &( cFailures[ xLength ] ), sizeof( cFailures ) - xLength, "%s%lu", ( xFailures == 0 ) ? "" : ",", ulStep );
+                    }
+
+                    xFailures++;
+                }
+            }
+        }
+
+        if( ( xInitialFreeBytes - xPortGetFreeHeapSize() ) > xPeakUsedBytes )
+        {
+            xPeakUsedBytes = xInitialFreeBytes - xPortGetFreeHeapSize();
+        }
+    }
+
+    vPortGetHeapStats( &xHeapStats );
+    printf( "%-16s | %6zu | %-16s | %9zu | %13zu\n", pcPolicy, xFailures, cFailures, xPeakUsedBytes, xHeapStats.xSizeOfLargestFreeBlockInBytes );
+
+    /* Empty the heap for the next replay. */
+    for( x = 0; x < xNumberOfBlocks; x++ )
+    {
+        vPortFree( pvBlocks[ x ] );
+    }
+}
+/*-----------------------------------------------------------*/
+
+static void prvWriteName( FILE * pxHeader,
+                          const char * pcName,
+                          size_t xWidth )
+{
+    size_t xLength = strlen( pcName );
+
+    /* Upper case, with '_' for anything a macro name cannot hold, padded to
+     * xWidth characters. */
+    for( ; *pcName != '\0'; pcName++ )
+    {
+        fputc( isalnum( ( unsigned char ) *pcName ) ? toupper( ( unsigned char ) *pcName ) : '_', pxHeader );
+    }
+
+    for( ; xLength < xWidth; xLength++ )
+    {
+        fputc( ' ', pxHeader );
+    }
+}
+/*-----------------------------------------------------------*/
+
+static void prvWriteHeader( FILE * pxHeader,
+                            const char * pcHeader,
+                            const char * pcTable,
+                            const char * pcPrefix,
+                            size_t xArenaSize )
+{
+    const char * pcGuard = strrchr( pcHeader, '/' );
+    char cOffset[ 24 ];
+    size_t x, xWidth = 0;
+
+    pcGuard = ( pcGuard != NULL ) ? ( pcGuard + 1 ) : pcHeader;
+
+    fprintf( pxHeader, "/* Generated by tools/heap_planner from %s, do not edit. */\n\n", pcTable );
+    fprintf( pxHeader, "#ifndef " );
+    prvWriteName( pxHeader, pcGuard, 0 );
+    fprintf( pxHeader, "\n#define " );
+    prvWriteName( pxHeader, pcGuard, 0 );
+    fprintf( pxHeader, "\n\n" );
+    fprintf( pxHeader, "/* Size of the arena, and the most bytes live at one step. */\n" );
+    fprintf( pxHeader, "#define %sARENA_SIZE     %zuU\n", pcPrefix, xArenaSize );
+    fprintf( pxHeader, "#define %sLOWER_BOUND    %zuU\n\n", pcPrefix, xLowerBound );
+    fprintf( pxHeader, "/* Offset of each block in the arena, a multiple of %d. */\n", portBYTE_ALIGNMENT );
+
+    for( x = 0; x < xNumberOfBlocks; x++ )
+    {
+        if( strlen( xBlocks[ x ].cName ) > xWidth )
+        {
+            xWidth = strlen( xBlocks[ x ].cName );
+        }
+    }
+
+    for( x = 0; x < xNumberOfBlocks; x++ )
+    {
+        fprintf( pxHeader, "#define %sOFFSET_", pcPrefix );
+        prvWriteName( pxHeader, xBlocks[ x ].cName, xWidth );
+        ( void ) snprintf( cOffset, sizeof( cOffset ), "%zuU", xBlocks[ x ].xOffset );
+        fprintf( pxHeader, "    %-8s    /* %zu bytes, steps %lu to ", cOffset, xBlocks[ x ].xSize, xBlocks[ x ].ulAllocated );
+
+        if( xBlocks[ x ].ulFreed == plannerNEVER_FREED )
+        {
+            fprintf( pxHeader, "the end. */\n" );
+        }
+        else
+        {
+            fprintf( pxHeader, "%lu. */\n", xBlocks[ x ].ulFreed );
+        }
+    }
+
+    fprintf( pxHeader, "\n#endif /* " );
+    prvWriteName( pxHeader, pcGuard, 0 );
+    fprintf( pxHeader, " */\n" );
+}
+/*-----------------------------------------------------------*/
+
+int main( int argc,
+          char ** argv )
+{
+    FILE * pxFile = stdin;
+    FILE * pxHeader;
+    const char * pcTable = "the standard input";
+    const char * pcHeader = NULL;
+    const char * pcPrefix = "plan";
+    BaseType_t xReplay = pdTRUE;
+    BaseType_t xOptimal;
+    size_t x, xArenaSize, xLiveTotal = 0;
+    int iArgument;
+
+    static const eHeapAllocationPolicy xPolicies[] = { eHeapPolicyFirstFit, eHeapPolicyBestFit, eHeapPolicyWorstFit, eHeapPolicyNextFit };
+    static const char * const pcPolicyNames[] = { "First-Fit", "Best-Fit", "Worst-Fit", "Next-Fit" };
+    size_t xPolicy;
+
+    for( iArgument = 1; iArgument < argc; iArgument++ )
+    {
+        if( strcmp( argv[ iArgument ], "-n" ) == 0 )
+        {
+            xReplay = pdFALSE;
+        }
+        else if( ( strcmp( argv[ iArgument ], "-o" ) == 0 ) && ( ( iArgument + 1 ) < argc ) )
+        {
+            iArgument++;
+            pcHeader = argv[ iArgument ];
+        }
+        else if( ( strcmp( argv[ iArgument ], "-p" ) == 0 ) && ( ( iArgument + 1 ) < argc ) )
+        {
+            iArgument++;
+            pcPrefix = argv[ iArgument ];
+        }
+        else
+        {
+            pcTable = argv[ iArgument ];
+            pxFile = fopen( pcTable, "r" );
+
+            if( pxFile == NULL )
+            {
+                perror( pcTable );
+                return EXIT_FAILURE;
+            }
+        }
+    }
+
+    prvReadTable( pxFile );
+
+    if( xNumberOfBlocks == 0 )
+    {
+        fprintf( stderr, "heap_planner: no blocks in the table\n" );
+        return EXIT_FAILURE;
+    }
+
+    xOptimal = prvPlan();
+    xArenaSize = prvArenaSize();
+
+    printf( "%-16s | %6s | %10s | %s\n", "Block", "Offset", "Size", "Steps" );
+
+    for( x = 0; x < xNumberOfBlocks; x++ )
+    {
+        xLiveTotal += xBlocks[ x ].xPlannedSize;
+
+        if( xBlocks[ x ].ulFreed == plannerNEVER_FREED )
+        {
+            printf( "%-16s | %6zu | %10zu | %lu-\n", xBlocks[ x ].cName, xBlocks[ x ].xOffset, xBlocks[ x ].xSize, xBlocks[ x ].ulAllocated );
+        }
+        else
+        {
+            printf( "%-16s | %6zu | %10zu | %lu-%lu\n", xBlocks[ x ].cName, xBlocks[ x ].xOffset, xBlocks[ x ].xSize, xBlocks[ x ].ulAllocated, xBlocks[ x ].ulFreed );
+        }
+    }
+
+    printf( "\nArena: %zu bytes for %zu blocks of %zu bytes in all, at least %zu bytes are live at one step (%s).\n",
+            xArenaSize, xNumberOfBlocks, xLiveTotal, xLowerBound,
+            ( xArenaSize == xLowerBound ) ? "optimal" :
+            ( ( xOptimal != pdFALSE ) ? "optimal, every order searched" : "largest first, too many blocks to search" ) );
+
+    if( pcHeader != NULL )
+    {
+        pxHeader = fopen( pcHeader, "w" );
+
+        if( pxHeader == NULL )
+        {
+            perror( pcHeader );
+            return EXIT_FAILURE;
+        }
+
+        prvWriteHeader( pxHeader, pcHeader, pcTable, pcPrefix, xArenaSize );
+        fclose( pxHeader );
+    }
+
+    if( xReplay != pdFALSE )
+    {
+        /* Initialise the heap, so every replay starts from the same state. */
+        vPortFree( pvPortMalloc( 1 ) );
+
+        printf( "\nThe same table allocated at run time from a %zu byte heap, block headers included:\n", ( size_t ) configTOTAL_HEAP_SIZE );
+        printf( "%-16s | %6s | %-16s | %9s | %13s\n", "Policy", "Fails", "Failed steps", "Peak used", "Final largest" );
+
+        for( xPolicy = 0; xPolicy < ( sizeof( xPolicies ) / sizeof( xPolicies[ 0 ] ) ); xPolicy++ )
+        {
+            ( void ) xPortSetAllocationPolicy( xPolicies[ xPolicy ] );
+            prvReplayWithPolicy( pcPolicyNames[ xPolicy ] );
+        }
+    }
+
+    return EXIT_SUCCESS;
+}
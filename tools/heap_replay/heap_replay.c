@@ -0,0 +1,482 @@
+/*
+ * FreeRTOS Kernel <DEVELOPMENT BRANCH>
+ * Copyright (C) 2021 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+
+/*
+ * Replay, on the host, a heap trace recorded on the target by
+ * MemMang/heap_trace.c and printed by vPortHeapTraceDump().
+ *
+ * The program is linked with heap_4_revised.c built for one allocation type,
+ * see the Makefile, and replays the trace once per policy of that type: the
+ * four run time policies of configHEAP_ALLOCATION_TYPE 8, or the single policy
+ * of the other types.  Each replay starts from an empty heap and prints one
+ * line with the failed allocations, the fragmentation of the free space and
+ * the cost of pvPortMalloc() and vPortFree() on the host.
+ *
+ *     heap_replay_list [-n] [trace file]
+ *
+ * The trace is read from the standard input when no file is given.  Lines
+ * that do not start with the "@HT" tag are skipped, so the whole UART output
+ * of the target can be given as it is.  -n leaves out the table header.
+ *
+ * The trace holds block sizes, header included.  They are replayed as they
+ * are, so the blocks have the same size as on the target when the tool is
+ * built for a 32 bit host (make M32=-m32).
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include "heap_4_revised.h"
+
+/* Size of the header pvPortMalloc() puts in front of a block on a host with
+ * pointers of uxPointerSize bytes. */
+#define replayHEADER_SIZE( uxPointerSize )    ( ( ( 2U * ( uxPointerSize ) ) + portBYTE_ALIGNMENT_MASK ) & ~( ( size_t ) portBYTE_ALIGNMENT_MASK ) )
+
+#if ( configHEAP_ALLOCATION_TYPE == 1 ) && ( configHEAP_BEST_FIT_TREE == 1 )
+    #define replayPOLICY_NAME    "Best-Fit (tree)"
+#elif ( configHEAP_ALLOCATION_TYPE == 1 )
+    #define replayPOLICY_NAME    "Best-Fit"
+#elif ( configHEAP_ALLOCATION_TYPE == 2 )
+    #define replayPOLICY_NAME    "Worst-Fit"
+#elif ( configHEAP_ALLOCATION_TYPE == 4 )
+    #define replayPOLICY_NAME    "TLSF"
+#elif ( configHEAP_ALLOCATION_TYPE == 5 )
+    #define replayPOLICY_NAME    "Segregated-Fit"
+#elif ( configHEAP_ALLOCATION_TYPE == 6 )
+    #define replayPOLICY_NAME    "Next-Fit"
+#elif ( configHEAP_ALLOCATION_TYPE == 7 )
+    #define replayPOLICY_NAME    "Buddy"
+#else
+    #define replayPOLICY_NAME    "First-Fit"
+#endif
+
+/* Number of failed allocations listed per replay. */
+#define replayFAILURES_SHOWN    4U
+
+/* One record of the trace. */
+typedef struct xReplayOperation
+{
+    uint32_t ulAddress;  /* Address on the target, 0 for an allocation that failed there. */
+    uint32_t ulSize;     /* Block size on the target. */
+    BaseType_t xIsFree;  /* pdTRUE for a vPortFree(). */
+} ReplayOperation_t;
+
+/* A block allocated by the replay, with the target address it stands for. */
+typedef struct xReplayBlock
+{
+    uint32_t ulAddress;
+    void * pvBlock;
+} ReplayBlock_t;
+
+/* What one replay measured. */
+typedef struct xReplayResult
+{
+    size_t xFailures;
+    size_t xFailedOperations[ replayFAILURES_SHOWN ];
+    size_t xPeakUsedBytes;
+    size_t xFinalFreeBytes;
+    size_t xFinalLargestFreeBlock;
+    double dMaxFragmentation;
+    double dMeanFragmentation;
+    double dMallocNanoseconds;
+    double dMallocMaxNanoseconds;
+    double dFreeNanoseconds;
+    double dFreeMaxNanoseconds;
+} ReplayResult_t;
+
+/*-----------------------------------------------------------*/
+
+static ReplayOperation_t * pxOperations = NULL;
+static size_t xNumberOfOperations = 0;
+static size_t xTargetHeapSize = 0;
+static size_t xTargetPointerSize = 0;
+
+static ReplayBlock_t * pxLiveBlocks = NULL;
+static size_t xNumberOfLiveBlocks = 0;
+
+/*-----------------------------------------------------------*/
+
+void vTaskSuspendAll( void )
+{
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xTaskResumeAll( void )
+{
+    return pdFALSE;
+}
+/*-----------------------------------------------------------*/
+
+void vAssertCalled( const char * pcFileName,
+                    unsigned long ulLine )
+{
+    fprintf( stderr, "heap_replay: assertion failed in %s line %lu\n", pcFileName, ulLine );
+    abort();
+}
+/*-----------------------------------------------------------*/
+
+static double prvNanoseconds( const struct timespec * pxStart,
+                              const struct timespec * pxEnd )
+{
+    return ( ( double ) ( pxEnd->tv_sec - pxStart->tv_sec ) * 1e9 ) + ( double ) ( pxEnd->tv_nsec - pxStart->tv_nsec );
+}
+/*-----------------------------------------------------------*/
+
+static void prvReadTrace( FILE * pxFile )
+{
+    char cLine[ 256 ];
+    char * pcRecord;
+    unsigned int uxTimestamp, uxTask, uxSize, uxAddress, uxLost, uxHeapSize, uxPointerSize, uxRecords;
+    char cOperation;
+    size_t xCapacity = 0;
+
+    while( fgets( cLine, sizeof( cLine ), pxFile ) != NULL )
+    {
+        pcRecord = strstr( cLine, "@HT " );
+
+        if( pcRecord == NULL )
+        {
+            continue;
+        }
+
+        pcRecord += 4;
+
+        if( sscanf( pcRecord, "begin %u %u %u %u", &uxRecords, &uxLost, &uxHeapSize, &uxPointerSize ) == 4 )
+        {
+            /* A later dump replaces an earlier one. */
+            xNumberOfOperations = 0;
+            xTargetHeapSize = uxHeapSize;
+            xTargetPointerSize = uxPointerSize;
+
+            if( uxLost != 0U )
+            {
+                fprintf( stderr, "heap_replay: %u older records were overwritten on the target, the blocks they allocated are never freed\n", uxLost );
+            }
+        }
+        else if( sscanf( pcRecord, "%u %x %c %u %x", &uxTimestamp, &uxTask, &cOperation, &uxSize, &uxAddress ) == 5 )
+        {
+            if( xNumberOfOperations == xCapacity )
+            {
+                xCapacity = ( xCapacity == 0 ) ? 1024 : ( xCapacity * 2 );
+                pxOperations = realloc( pxOperations, xCapacity * sizeof( ReplayOperation_t ) );
+
+                if( pxOperations == NULL )
+                {
+                    fprintf( stderr, "heap_replay: out of memory\n" );
+                    exit( EXIT_FAILURE );
+                }
+            }
+
+            pxOperations[ xNumberOfOperations ].ulAddress = uxAddress;
+            pxOperations[ xNumberOfOperations ].ulSize = uxSize;
+            pxOperations[ xNumberOfOperations ].xIsFree = ( cOperation == 'F' ) ? pdTRUE : pdFALSE;
+            xNumberOfOperations++;
+        }
+        else
+        {
+            /* "@HT end" or a damaged line. */
+        }
+    }
+
+    pxLiveBlocks = malloc( ( xNumberOfOperations + 1 ) * sizeof( ReplayBlock_t ) );
+
+    if( pxLiveBlocks == NULL )
+    {
+        fprintf( stderr, "heap_replay: out of memory\n" );
+        exit( EXIT_FAILURE );
+    }
+}
+/*-----------------------------------------------------------*/
+
+static ReplayBlock_t * prvFindLiveBlock( uint32_t ulAddress )
+{
+    size_t x;
+
+    for( x = 0; x < xNumberOfLiveBlocks; x++ )
+    {
+        if( pxLiveBlocks[ x ].ulAddress == ulAddress )
+        {
+            return &( pxLiveBlocks[ x ] );
+        }
+    }
+
+    return NULL;
+}
+/*-----------------------------------------------------------*/
+
+static void prvReplay( ReplayResult_t * pxResult )
+{
+    const ReplayOperation_t * pxOperation;
+    ReplayBlock_t * pxLiveBlock;
+    HeapStats_t xHeapStats;
+    struct timespec xStart, xEnd;
+    size_t x, xInitialFreeBytes, xRequest, xMallocs = 0, xFrees = 0;
+    size_t xHeaderSize = replayHEADER_SIZE( sizeof( void * ) );
+    double dNanoseconds, dFragmentation, dFragmentationSum = 0.0;
+    void * pvBlock;
+
+    memset( pxResult, 0, sizeof( *pxResult ) );
+    xInitialFreeBytes = xPortGetFreeHeapSize();
+
+    for( x = 0; x < xNumberOfOperations; x++ )
+    {
+        pxOperation = &( pxOperations[ x ] );
+
+        if( pxOperation->xIsFree == pdFALSE )
+        {
+            /* Requests of 0 bytes and objects served by a pool leave the heap
+             * alone. */
+            if( pxOperation->ulSize == 0U )
+            {
+                continue;
+            }
+
+            /* Ask for a block of the size the target had. */
+            xRequest = ( pxOperation->ulSize > xHeaderSize ) ? ( pxOperation->ulSize - xHeaderSize ) : 1U;
+
+            clock_gettime( CLOCK_MONOTONIC, &xStart );
+            pvBlock = pvPortMalloc( xRequest );
+            clock_gettime( CLOCK_MONOTONIC, &xEnd );
+
+            dNanoseconds = prvNanoseconds( &xStart, &xEnd );
+            pxResult->dMallocNanoseconds += dNanoseconds;
+            xMallocs++;
+
+            if( dNanoseconds > pxResult->dMallocMaxNanoseconds )
+            {
+                pxResult->dMallocMaxNanoseconds = dNanoseconds;
+            }
+
+            if( pvBlock == NULL )
+            {
+                if( pxResult->xFailures < replayFAILURES_SHOWN )
+                {
+                    pxResult->xFailedOperations[ pxResult->xFailures ] = x;
+                }
+
+                pxResult->xFailures++;
+            }
+            else if( pxOperation->ulAddress != 0U )
+            {
+                /* The block the target address stood for was freed by a
+                 * record that is not in the trace. */
+                pxLiveBlock = prvFindLiveBlock( pxOperation->ulAddress );
+
+                if( pxLiveBlock != NULL )
+                {
+                    vPortFree( pxLiveBlock->pvBlock );
+                }
+                else
+                {
+                    pxLiveBlock = &( pxLiveBlocks[ xNumberOfLiveBlocks ] );
+                    xNumberOfLiveBlocks++;
+                }
+
+                pxLiveBlock->ulAddress = pxOperation->ulAddress;
+                pxLiveBlock->pvBlock = pvBlock;
+            }
+            else
+            {
+                /* The target got NULL, so the application never used the
+                 * block. */
+                vPortFree( pvBlock );
+            }
+        }
+        else
+        {
+            pxLiveBlock = prvFindLiveBlock( pxOperation->ulAddress );
+
+            if( pxLiveBlock == NULL )
+            {
+                /* Allocated before the first record, or failed in this
+                 * replay. */
+                continue;
+            }
+
+            clock_gettime( CLOCK_MONOTONIC, &xStart );
+            vPortFree( pxLiveBlock->pvBlock );
+            clock_gettime( CLOCK_MONOTONIC, &xEnd );
+
+            dNanoseconds = prvNanoseconds( &xStart, &xEnd );
+            pxResult->dFreeNanoseconds += dNanoseconds;
+            xFrees++;
+
+            if( dNanoseconds > pxResult->dFreeMaxNanoseconds )
+            {
+                pxResult->dFreeMaxNanoseconds = dNanoseconds;
+            }
+
+            xNumberOfLiveBlocks--;
+            *pxLiveBlock = pxLiveBlocks[ xNumberOfLiveBlocks ];
+        }
+
+        /* External fragmentation: the part of the free space that is not in
+         * the largest free block. */
+        vPortGetHeapStats( &xHeapStats );
+        dFragmentation = 0.0;
+
+        if( xHeapStats.xAvailableHeapSpaceInBytes > 0 )
+        {
+            dFragmentation = 1.0 - ( ( double ) xHeapStats.xSizeOfLargestFreeBlockInBytes / ( double ) xHeapStats.xAvailableHeapSpaceInBytes );
+        }
+
+        dFragmentationSum += dFragmentation;
+
+        if( dFragmentation > pxResult->dMaxFragmentation )
+        {
+            pxResult->dMaxFragmentation = dFragmentation;
+        }
+
+        if( ( xInitialFreeBytes - xHeapStats.xAvailableHeapSpaceInBytes ) > pxResult->xPeakUsedBytes )
+        {
+            pxResult->xPeakUsedBytes = xInitialFreeBytes - xHeapStats.xAvailableHeapSpaceInBytes;
+        }
+    }
+
+    vPortGetHeapStats( &xHeapStats );
+    pxResult->xFinalFreeBytes = xHeapStats.xAvailableHeapSpaceInBytes;
+    pxResult->xFinalLargestFreeBlock = xHeapStats.xSizeOfLargestFreeBlockInBytes;
+    pxResult->dMeanFragmentation = ( xNumberOfOperations > 0 ) ? ( dFragmentationSum / ( double ) xNumberOfOperations ) : 0.0;
+    pxResult->dMallocNanoseconds = ( xMallocs > 0 ) ? ( pxResult->dMallocNanoseconds / ( double ) xMallocs ) : 0.0;
+    pxResult->dFreeNanoseconds = ( xFrees > 0 ) ? ( pxResult->dFreeNanoseconds / ( double ) xFrees ) : 0.0;
+
+    /* Empty the heap for the next replay. */
+    while( xNumberOfLiveBlocks > 0 )
+    {
+        xNumberOfLiveBlocks--;
+        vPortFree( pxLiveBlocks[ xNumberOfLiveBlocks ].pvBlock );
+    }
+}
+/*-----------------------------------------------------------*/
+
+static void prvPrintResult( const char * pcPolicy,
+                            const ReplayResult_t * pxResult )
+{
+    char cFailures[ 64 ] = "-";
+    size_t x, xLength = 0;
+
+    for( x = 0; ( x < pxResult->xFailures ) && ( x < replayFAILURES_SHOWN ); x++ )
+    {
+        xLength += ( size_t ) snprintf( &( cFailures[ xLength ] ), sizeof( cFailures ) - xLength, "%s%zu", ( x == 0 ) ? "" : ",", pxResult->xFailedOperations[ x ] );
+    }
+
+    if( pxResult->xFailures > replayFAILURES_SHOWN )
+    {
+        ( void ) snprintf( &( cFailures[ xLength ] ), sizeof( cFailures ) - xLength, ",..." );
+    }
+
+    printf( "%-16s | %6zu | %-24s | %9zu | %10zu | %13zu | %7.1f%% | %7.1f%% | %9.0f / %-9.0f | %9.0f / %-9.0f\n",
+            pcPolicy, pxResult->xFailures, cFailures, pxResult->xPeakUsedBytes,
+            pxResult->xFinalFreeBytes, pxResult->xFinalLargestFreeBlock,
+            pxResult->dMaxFragmentation * 100.0, pxResult->dMeanFragmentation * 100.0,
+            pxResult->dMallocNanoseconds, pxResult->dMallocMaxNanoseconds,
+            pxResult->dFreeNanoseconds, pxResult->dFreeMaxNanoseconds );
+}
+/*-----------------------------------------------------------*/
+
+int main( int argc,
+          char ** argv )
+{
+    FILE * pxFile = stdin;
+    BaseType_t xPrintHeader = pdTRUE;
+    ReplayResult_t xResult;
+    int iArgument;
+
+    #if ( configHEAP_ALLOCATION_TYPE == 8 )
+        static const eHeapAllocationPolicy xPolicies[] = { eHeapPolicyFirstFit, eHeapPolicyBestFit, eHeapPolicyWorstFit, eHeapPolicyNextFit };
+        static const char * const pcPolicyNames[] = { "First-Fit", "Best-Fit", "Worst-Fit", "Next-Fit" };
+        size_t xPolicy;
+    #endif
+
+    for( iArgument = 1; iArgument < argc; iArgument++ )
+    {
+        if( strcmp( argv[ iArgument ], "-n" ) == 0 )
+        {
+            xPrintHeader = pdFALSE;
+        }
+        else
+        {
+            pxFile = fopen( argv[ iArgument ], "r" );
+
+            if( pxFile == NULL )
+            {
+                perror( argv[ iArgument ] );
+                return EXIT_FAILURE;
+            }
+        }
+    }
+
+    prvReadTrace( pxFile );
+
+    if( xNumberOfOperations == 0 )
+    {
+        fprintf( stderr, "heap_replay: no \"@HT\" records found\n" );
+        return EXIT_FAILURE;
+    }
+
+    if( ( xTargetHeapSize != configTOTAL_HEAP_SIZE ) || ( xTargetPointerSize != sizeof( void * ) ) )
+    {
+        fprintf( stderr, "heap_replay: the target had a %zu byte heap and %zu byte pointers, this build %zu and %zu\n",
+                 xTargetHeapSize, xTargetPointerSize, ( size_t ) configTOTAL_HEAP_SIZE, sizeof( void * ) );
+    }
+
+    /* Initialise the heap, so every replay starts from the same state. */
+    vPortFree( pvPortMalloc( 1 ) );
+
+    if( xPrintHeader != pdFALSE )
+    {
+        printf( "%zu operations replayed on a %zu byte heap.  Failed = operation numbers of the first failed allocations.\n",
+                xNumberOfOperations, ( size_t ) configTOTAL_HEAP_SIZE );
+        printf( "%-16s | %6s | %-24s | %9s | %10s | %13s | %8s | %8s | %-21s | %-21s\n",
+                "Policy", "Fails", "Failed", "Peak used", "Final free", "Final largest",
+                "Max frag", "Avg frag", "malloc ns avg / max", "free ns avg / max" );
+    }
+
+    #if ( configHEAP_ALLOCATION_TYPE == 8 )
+    {
+        for( xPolicy = 0; xPolicy < ( sizeof( xPolicies ) / sizeof( xPolicies[ 0 ] ) ); xPolicy++ )
+        {
+            ( void ) xPortSetAllocationPolicy( xPolicies[ xPolicy ] );
+            prvReplay( &xResult );
+            prvPrintResult( pcPolicyNames[ xPolicy ], &xResult );
+        }
+    }
+    #else
+    {
+        prvReplay( &xResult );
+        prvPrintResult( replayPOLICY_NAME, &xResult );
+    }
+    #endif
+
+    return EXIT_SUCCESS;
+}